@@ -23,21 +23,20 @@
  */
 
 #include <string>
-#include <locale>
-#include <codecvt>
 #include <iostream>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <exception>
 
 #include "JSON.h"
-
-// Pulled from cppreference codecvt page
-// utility wrapper to adapt locale-bound facets for string/wbuffer convert
-template<class Facet>
-struct deletable_facet : Facet
-{
-    template<class... Args>
-    deletable_facet(Args&&... args) : Facet(std::forward<Args>(args)...) {}
-    ~deletable_facet() {}
-};
+#include "JSONSimd.h"
+#include "JSONNumber.h"
 
 /**
  * Parses a complete JSON encoded string
@@ -51,21 +50,914 @@ struct deletable_facet : Facet
  */
 JSONValue JSON::Parse(const std::string &data)
 {
-    const char *data_ptr = data.c_str();
+    JSONParseContext context;
+    return ParseDocument(data.data(), data.data() + data.size(), context);
+}
+
+/**
+ * Parses a complete JSON encoded string of a known length
+ * The text needn't be NULL terminated, so it can be a slice of a larger
+ * buffer (e.g. one read from the network or mapped from a file)
+ *
+ * @access public
+ *
+ * @param char* data The JSON text
+ * @param size_t length The length of the JSON text
+ * @param int flags JSONParse_Indexed or JSONParse_Default
+ *
+ * @return JSONValue Returns a JSON Value representing the root,
+ #         or throw JSONException on error
+ */
+JSONValue JSON::Parse(const char *data, size_t length, int flags)
+{
+    if (data == 0)
+        throw JSONException();
+
+    JSONParseContext context;
+    context.indexed = (flags & JSONParse_Indexed) != 0;
+    return ParseDocument(data, data + length, context);
+}
+
+/**
+ * Parses a complete JSON encoded string into an arena
+ * All containers and strings of the result are allocated from the arena,
+ * so the result must be destroyed before the arena is Reset()
+ *
+ * @access public
+ *
+ * @param std::string data The JSON text
+ * @param JSONArena arena The arena to allocate the values from
+ *
+ * @return JSONValue Returns a JSON Value representing the root,
+ #         or throw JSONException on error
+ */
+JSONValue JSON::Parse(const std::string &data, JSONArena &arena)
+{
+    JSONParseContext context;
+    context.arena = &arena;
+    return ParseDocument(data.data(), data.data() + data.size(), context);
+}
+
+/**
+ * Parses a complete JSON encoded string, interning its object keys
+ * Keys already in the pool aren't copied again, so documents that repeat
+ * the same keys share them. The pool must outlive the result.
+ *
+ * @access public
+ *
+ * @param std::string data The JSON text
+ * @param JSONKeyPool keys The pool to intern the keys in, which may be
+ *                         shared between threads
+ *
+ * @return JSONValue Returns a JSON Value representing the root,
+ #         or throw JSONException on error
+ */
+JSONValue JSON::Parse(const std::string &data, JSONKeyPool &keys)
+{
+    JSONParseContext context;
+    context.keys = &keys;
+    return ParseDocument(data.data(), data.data() + data.size(), context);
+}
+
+/**
+ * Parses a complete JSON encoded string into an arena, interning its
+ * object keys. As Parse(data, arena) and Parse(data, keys) together.
+ *
+ * @access public
+ *
+ * @param std::string data The JSON text
+ * @param JSONArena arena The arena to allocate the values from
+ * @param JSONKeyPool keys The pool to intern the keys in
+ *
+ * @return JSONValue Returns a JSON Value representing the root,
+ #         or throw JSONException on error
+ */
+JSONValue JSON::Parse(const std::string &data, JSONArena &arena, JSONKeyPool &keys)
+{
+    JSONParseContext context;
+    context.arena = &arena;
+    context.keys = &keys;
+    return ParseDocument(data.data(), data.data() + data.size(), context);
+}
+
+/**
+ * Parses a complete JSON encoded string without copying its strings
+ * String values without escapes refer straight into the given text, so
+ * the text must outlive the result. Only escaped strings are copied.
+ *
+ * @access public
+ *
+ * @param char* data The NULL terminated JSON text
+ * @param int flags Any JSONParseFlags to use
+ *
+ * @return JSONValue Returns a JSON Value representing the root,
+ #         or throw JSONException on error
+ */
+JSONValue JSON::ParseView(const char *data, int flags)
+{
+    JSONParseContext context;
+    context.borrow_strings = true;
+    context.lazy_numbers = (flags & JSONParse_LazyNumbers) != 0;
+    context.indexed = (flags & JSONParse_Indexed) != 0;
+    return ParseDocument(data, data + strlen(data), context);
+}
+
+/**
+ * Parses a complete JSON encoded string into an arena without copying its strings
+ * As ParseView(data), except that containers and any escaped strings are
+ * allocated from the arena.
+ *
+ * @access public
+ *
+ * @param char* data The NULL terminated JSON text
+ * @param JSONArena arena The arena to allocate the values from
+ * @param int flags Any JSONParseFlags to use
+ *
+ * @return JSONValue Returns a JSON Value representing the root,
+ #         or throw JSONException on error
+ */
+JSONValue JSON::ParseView(const char *data, JSONArena &arena, int flags)
+{
+    JSONParseContext context;
+    context.arena = &arena;
+    context.borrow_strings = true;
+    context.lazy_numbers = (flags & JSONParse_LazyNumbers) != 0;
+    context.indexed = (flags & JSONParse_Indexed) != 0;
+    return ParseDocument(data, data + strlen(data), context);
+}
+
+/**
+ * Parses a complete JSON encoded string, unescaping its strings in place
+ * The text is overwritten and all string values refer into it, so it must
+ * outlive the result. No memory is allocated for strings at all.
+ *
+ * @access public
+ *
+ * @param char* buf The JSON text
+ * @param size_t len The length of the JSON text
+ * @param int flags Any JSONParseFlags to use
+ *
+ * @return JSONValue Returns a JSON Value representing the root,
+ #         or throw JSONException on error
+ */
+JSONValue JSON::ParseInSitu(char *buf, size_t len, int flags)
+{
+    JSONParseContext context;
+    context.borrow_strings = true;
+    context.in_situ = true;
+    context.lazy_numbers = (flags & JSONParse_LazyNumbers) != 0;
+    return ParseInSituDocument(buf, len, context);
+}
+
+/**
+ * Parses a complete JSON encoded string into an arena, unescaping its
+ * strings in place. As ParseInSitu(buf, len), except that containers are
+ * allocated from the arena.
+ *
+ * @access public
+ *
+ * @param char* buf The JSON text
+ * @param size_t len The length of the JSON text
+ * @param JSONArena arena The arena to allocate the values from
+ * @param int flags Any JSONParseFlags to use
+ *
+ * @return JSONValue Returns a JSON Value representing the root,
+ #         or throw JSONException on error
+ */
+JSONValue JSON::ParseInSitu(char *buf, size_t len, JSONArena &arena, int flags)
+{
+    JSONParseContext context;
+    context.arena = &arena;
+    context.borrow_strings = true;
+    context.in_situ = true;
+    context.lazy_numbers = (flags & JSONParse_LazyNumbers) != 0;
+    return ParseInSituDocument(buf, len, context);
+}
+
+/**
+ * Parses a complete JSON document of a known length held in a writable buffer
+ *
+ * @access protected
+ *
+ * @param char* buf The JSON text
+ * @param size_t len The length of the JSON text
+ * @param JSONParseContext context The state for this parse
+ *
+ * @return JSONValue Returns a JSON Value representing the root,
+ #         or throw JSONException on error
+ */
+JSONValue JSON::ParseInSituDocument(char *buf, size_t len, JSONParseContext &context)
+{
+    if (buf == 0)
+        throw JSONException();
+
+    return ParseDocument(buf, buf + len, context);
+}
+
+/**
+ * Parses a complete JSON document
+ *
+ * @access protected
+ *
+ * @param char* data The JSON text
+ * @param char* end The end of the JSON text
+ * @param JSONParseContext context The state for this parse
+ *
+ * @return JSONValue Returns a JSON Value representing the root,
+ #         or throw JSONException on error
+ */
+JSONValue JSON::ParseDocument(const char *data, const char *end, JSONParseContext &context)
+{
+    // When asked for and with SIMD the structure is found up front and
+    // walked, in situ parses rewrite the text ahead of the index so they're
+    // parsed recursively
+    if (context.indexed && simplejson_simd_level() != JSONSimd_Scalar && !context.in_situ)
+    {
+        // The batch buffer is kept for the thread's later parses rather
+        // than taking up the stack of each one
+        static thread_local std::vector<std::uint32_t> tokens(JSONStructuralIndex::batch_size);
+        JSONStructuralIndex index(data, end - data, tokens.data());
+        JSONValue value = JSONValue::ParseIndexed(index, context);
+
+        // Should be at the end of the string then...
+        if (index.Current() != end)
+            throw JSONException();
+
+        return value;
+    }
+
+    const char *data_ptr = data;
 
     // Skip any preceding whitespace, end of data = no JSON = fail
-    if (!SkipWhitespace(&data_ptr))
+    if (!SkipWhitespace(&data_ptr, end))
+        throw JSONException();
+
+    // We need the start of a value here now...
+    JSONValue value = JSONValue::Parse(&data_ptr, end, context);
+    
+    // Can be white space now and should be at the end of the string then...
+    if (SkipWhitespace(&data_ptr, end))
+        throw JSONException();
+    
+    // We're now at the end of the string
+    return value;
+}
+
+// A run of whole elements of a top level array, parsed by one thread
+struct JSONArrayChunk
+{
+    // From the first element to the , or ] after the last
+    const char *start;
+    const char *end;
+
+    // The indices of the first element and the one after the last
+    size_t first_index;
+    size_t end_index;
+};
+
+/**
+ * Splits the elements of an array into chunks of about the given size.
+ * Only strings and brackets are followed to find the commas between the
+ * elements, the elements themselves are checked when they're parsed.
+ *
+ * @param char* data The text after the array's [, which isn't empty
+ * @param char* end The end of the text
+ * @param size_t chunk_size The size to make the chunks
+ * @param std::vector<JSONArrayChunk> chunks Receives the chunks
+ *
+ * @return char* Returns the array's ], or throw JSONException if it has none
+ */
+static const char *SplitArray(const char *data, const char *end, size_t chunk_size, std::vector<JSONArrayChunk> &chunks)
+{
+    const char *chunk_start = data;
+    size_t chunk_first = 0;
+    size_t index = 0;
+    size_t depth = 0;
+
+    for (const char *ptr = data; ptr < end; ptr++)
+    {
+        switch (*ptr)
+        {
+            // Skip over strings so the brackets and commas in them are ignored
+            case '"':
+                ptr = simplejson_find_escape(ptr + 1, end);
+                while (ptr != end && *ptr != '"')
+                {
+                    if (*ptr == '\\' && ++ptr == end)
+                        break;
+
+                    ptr = simplejson_find_escape(ptr + 1, end);
+                }
+
+                if (ptr == end)
+                    throw JSONException();
+                break;
+
+            case '[':
+            case '{':
+                depth++;
+                break;
+
+            case '}':
+            case ']':
+                if (depth-- == 0)
+                {
+                    if (*ptr != ']')
+                        throw JSONException();
+
+                    chunks.push_back({ chunk_start, ptr, chunk_first, index + 1 });
+                    return ptr;
+                }
+                break;
+
+            // A comma in the array itself ends an element, and the chunk if
+            // it's big enough
+            case ',':
+                if (depth == 0)
+                {
+                    if (static_cast<size_t>(ptr - chunk_start) >= chunk_size)
+                    {
+                        chunks.push_back({ chunk_start, ptr, chunk_first, index + 1 });
+                        chunk_start = ptr + 1;
+                        chunk_first = index + 1;
+                    }
+                    index++;
+                }
+                break;
+        }
+    }
+
+    throw JSONException();
+}
+
+/**
+ * Parses a complete JSON encoded string using several threads when it's an
+ * array. The elements are found by a quick scan of the text first, then
+ * parsed in chunks by each thread straight into their place in the array.
+ * Anything other than an array is parsed as JSON::Parse() does.
+ *
+ * @access public
+ *
+ * @param std::string data The JSON text
+ * @param unsigned int threads How many threads to use, 0 for one per core
+ *
+ * @return JSONValue Returns a JSON Value representing the root,
+ #         or throw JSONException on error
+ */
+JSONValue JSON::ParseParallel(const std::string &data, unsigned int threads)
+{
+    // Only non-empty arrays are worth splitting up
+    const char *start = data.data();
+    const char *end = start + data.size();
+    if (!SkipWhitespace(&start, end))
+        throw JSONException();
+
+    const char *first = start + 1;
+    if (*start != '[' || !SkipWhitespace(&first, end) || *first == ']')
+        return Parse(data);
+
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+
+    // Several chunks per thread keep them all busy when some elements take
+    // longer than others, but each must be big enough to be worth a turn
+    std::vector<JSONArrayChunk> chunks;
+    size_t chunk_size = std::max<size_t>(data.size() / (threads * 8) + 1, 64 * 1024);
+    const char *close = SplitArray(first, end, chunk_size, chunks);
+
+    // Can be white space now and should be at the end of the string then...
+    close++;
+    if (SkipWhitespace(&close, end))
         throw JSONException();
 
-    // We need the start of a value here now...
-    JSONValue value = JSONValue::Parse(&data_ptr);
-    
-    // Can be white space now and should be at the end of the string then...
-    if (SkipWhitespace(&data_ptr))
+    JSONArray array(chunks.back().end_index);
+    std::atomic<size_t> next_chunk(0);
+    std::atomic<bool> failed(false);
+
+    // The first thing a worker threw, e.g. std::bad_alloc, rethrown on this
+    // thread once they've all finished
+    std::exception_ptr error;
+    std::mutex error_mutex;
+
+    auto worker = [&]()
+    {
+        JSONParseContext context;
+        for (size_t index = next_chunk++; index < chunks.size() && !failed; index = next_chunk++)
+        {
+            const JSONArrayChunk &chunk = chunks[index];
+            const char *ptr = chunk.start;
+            size_t element = chunk.first_index;
+
+            try
+            {
+                // Each element must end at a comma the scan found, so the
+                // elements land where it expects them
+                while (true)
+                {
+                    if (element == chunk.end_index || !SkipWhitespace(&ptr, end))
+                        throw JSONException();
+
+                    array[element++] = JSONValue::Parse(&ptr, end, context);
+
+                    if (!SkipWhitespace(&ptr, end) || ptr > chunk.end)
+                        throw JSONException();
+
+                    if (ptr == chunk.end)
+                        break;
+
+                    if (*(ptr++) != ',')
+                        throw JSONException();
+                }
+
+                if (element != chunk.end_index)
+                    throw JSONException();
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(error_mutex);
+                if (!error)
+                    error = std::current_exception();
+                failed = true;
+            }
+        }
+    };
+
+    // This thread takes chunks too
+    std::vector<std::thread> workers;
+    for (unsigned int i = 1; i < threads && i < chunks.size(); i++)
+        workers.emplace_back(worker);
+
+    worker();
+    for (size_t i = 0; i < workers.size(); i++)
+        workers[i].join();
+
+    if (error)
+        std::rethrow_exception(error);
+
+    return JSONValue(std::move(array));
+}
+
+// A run of whole lines of a JSON Lines text, parsed by one thread
+struct JSONLineChunk
+{
+    const char *start;
+    const char *end;
+
+    // Filled in by the parse, line numbers count from the chunk's first line
+    std::vector<JSONValue> values;
+    std::vector<size_t> lines;
+    size_t line_count = 0;
+    size_t error_line = 0;
+
+    // Anything other than a JSONException thrown while parsing, e.g.
+    // std::bad_alloc, to be rethrown in its place among the lines
+    std::exception_ptr error;
+    bool done = false;
+};
+
+/**
+ * Lowers the index of the last chunk worth parsing
+ *
+ * @param std::atomic<size_t> stop_after The index to lower
+ * @param size_t index The chunk that should be the last
+ */
+static void StopAfterChunk(std::atomic<size_t> &stop_after, size_t index)
+{
+    size_t current = stop_after.load();
+    while (index < current && !stop_after.compare_exchange_weak(current, index))
+    {
+    }
+}
+
+/**
+ * Parses each line of a chunk, skipping blank ones, until the end of the
+ * chunk, an invalid line, or an invalid line is found in an earlier chunk.
+ * Nothing is thrown, so that a worker thread always gets to mark it done.
+ *
+ * @param JSONLineChunk chunk The chunk to parse
+ * @param size_t index The index of the chunk
+ * @param std::atomic<size_t> stop_after The last chunk worth parsing
+ */
+static void ParseLineChunk(JSONLineChunk &chunk, size_t index, std::atomic<size_t> &stop_after)
+{
+    const char *ptr = chunk.start;
+    while (ptr < chunk.end && index <= stop_after.load(std::memory_order_relaxed))
+    {
+        const char *line_end = static_cast<const char *>(memchr(ptr, '\n', chunk.end - ptr));
+        if (line_end == 0)
+            line_end = chunk.end;
+        chunk.line_count++;
+
+        // Lines that are only whitespace hold no value
+        const char *first = ptr;
+        while (first < line_end && (*first == ' ' || *first == '\t' || *first == '\r'))
+            first++;
+
+        if (first < line_end)
+        {
+            try
+            {
+                chunk.values.push_back(JSON::Parse(first, line_end - first));
+                chunk.lines.push_back(chunk.line_count);
+            }
+            catch (const JSONException &e)
+            {
+                chunk.error_line = chunk.line_count;
+                StopAfterChunk(stop_after, index);
+                break;
+            }
+            catch (...)
+            {
+                chunk.error = std::current_exception();
+                StopAfterChunk(stop_after, index);
+                break;
+            }
+        }
+
+        ptr = line_end + 1;
+    }
+}
+
+/**
+ * Parses a JSON Lines text, where each line is a separate JSON document,
+ * using several threads. Blank lines are skipped.
+ *
+ * @access public
+ *
+ * @param std::string data The JSON Lines text
+ * @param unsigned int threads How many threads to use, 0 for one per core
+ *
+ * @return std::vector<JSONValue> Returns the value of each line in order,
+ *         or throw JSONException if any line is invalid
+ */
+std::vector<JSONValue> JSON::ParseLines(const std::string &data, unsigned int threads)
+{
+    std::vector<JSONValue> values;
+    ParseLines(data, [&values](size_t, JSONValue &&value) { values.push_back(std::move(value)); }, threads);
+    return values;
+}
+
+/**
+ * Parses a JSON Lines text using several threads, handing each value to the
+ * callback in the order of the lines. The text is split into chunks of whole
+ * lines, which idle threads take in turn, and the callback is called on this
+ * thread as each chunk is finished. Blank lines are skipped.
+ *
+ * @access public
+ *
+ * @param std::string data The JSON Lines text
+ * @param std::function callback Called with the line number (from 1) and value of each line
+ * @param unsigned int threads How many threads to use, 0 for one per core
+ *
+ * @return void Throws JSONException naming the first invalid line, or
+ *         whatever else parsing a line threw, after the callback has been
+ *         given every line before it
+ */
+void JSON::ParseLines(const std::string &data, const std::function<void(size_t, JSONValue &&)> &callback,
+                      unsigned int threads)
+{
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+
+    // Several chunks per thread keep them all busy when some lines take
+    // longer than others. They're kept small so the values of each chunk are
+    // still in the cache when they're handed over.
+    const char *ptr = data.data();
+    const char *end = ptr + data.size();
+    size_t chunk_size = std::min<size_t>(data.size() / (threads * 8) + 1, 64 * 1024);
+
+    std::vector<JSONLineChunk> chunks;
+    while (ptr < end)
+    {
+        const char *chunk_end = ptr + std::min(chunk_size, static_cast<size_t>(end - ptr));
+        if (chunk_end < end)
+        {
+            const char *newline = static_cast<const char *>(memchr(chunk_end, '\n', end - chunk_end));
+            chunk_end = newline == 0 ? end : newline + 1;
+        }
+
+        chunks.emplace_back();
+        chunks.back().start = ptr;
+        chunks.back().end = chunk_end;
+        ptr = chunk_end;
+    }
+
+    // Chunks after one with an invalid line aren't needed, so stop_after is
+    // lowered to let the threads skip them
+    std::atomic<size_t> next_chunk(0);
+    std::atomic<size_t> stop_after(chunks.size());
+    std::mutex done_mutex;
+    std::condition_variable done_condition;
+
+    auto worker = [&]()
+    {
+        for (size_t index = next_chunk++; index < chunks.size(); index = next_chunk++)
+        {
+            ParseLineChunk(chunks[index], index, stop_after);
+
+            std::lock_guard<std::mutex> lock(done_mutex);
+            chunks[index].done = true;
+            done_condition.notify_all();
+        }
+    };
+
+    // A single thread may as well be this one
+    std::vector<std::thread> workers;
+    if (threads > 1 && chunks.size() > 1)
+    {
+        for (unsigned int i = 0; i < threads && i < chunks.size(); i++)
+            workers.emplace_back(worker);
+    }
+
+    // Hand the values over in order as the chunks finish, freeing each one
+    // as it goes, up to the first invalid line
+    size_t first_line = 0;
+    size_t error_line = 0;
+    for (size_t index = 0; index < chunks.size() && error_line == 0; index++)
+    {
+        JSONLineChunk &chunk = chunks[index];
+        if (workers.empty())
+        {
+            ParseLineChunk(chunk, index, stop_after);
+        }
+        else
+        {
+            std::unique_lock<std::mutex> lock(done_mutex);
+            done_condition.wait(lock, [&chunk]() { return chunk.done; });
+        }
+
+        try
+        {
+            for (size_t i = 0; i < chunk.values.size(); i++)
+                callback(first_line + chunk.lines[i], std::move(chunk.values[i]));
+        }
+        catch (...)
+        {
+            StopAfterChunk(stop_after, index);
+            for (size_t i = 0; i < workers.size(); i++)
+                workers[i].join();
+            throw;
+        }
+
+        if (chunk.error)
+        {
+            for (size_t i = 0; i < workers.size(); i++)
+                workers[i].join();
+            std::rethrow_exception(chunk.error);
+        }
+
+        if (chunk.error_line != 0)
+            error_line = first_line + chunk.error_line;
+
+        first_line += chunk.line_count;
+        std::vector<JSONValue>().swap(chunk.values);
+    }
+
+    for (size_t i = 0; i < workers.size(); i++)
+        workers[i].join();
+
+    if (error_line != 0)
+        throw JSONException("Invalid JSON on line " + std::to_string(error_line));
+}
+
+/**
+ * Parses a complete JSON encoded string, handing each part of it to the
+ * handler as it's read rather than building a tree. Nothing is allocated
+ * other than a buffer for unescaping strings that have escapes.
+ *
+ * @access public
+ *
+ * @param char* data The NULL terminated JSON text
+ * @param JSONHandler handler The handler to receive the document
+ *
+ * @return bool Returns true if the whole document was valid and handled,
+ *              false if it was invalid or the handler stopped the parse
+ */
+bool JSON::ParseEvents(const char *data, JSONHandler &handler)
+{
+    return ParseEvents(data, strlen(data), handler);
+}
+
+/**
+ * Parses a complete JSON encoded string of a known length, handing each
+ * part of it to the handler. As ParseEvents(data, handler), except that the
+ * text needn't be NULL terminated.
+ *
+ * @access public
+ *
+ * @param char* data The JSON text
+ * @param size_t length The length of the JSON text
+ * @param JSONHandler handler The handler to receive the document
+ *
+ * @return bool Returns true if the whole document was valid and handled,
+ *              false if it was invalid or the handler stopped the parse
+ */
+bool JSON::ParseEvents(const char *data, size_t length, JSONHandler &handler)
+{
+    if (data == 0)
+        return false;
+
+    std::string scratch;
+    const char *end = data + length;
+
+    try
+    {
+        // Skip any preceding whitespace, end of data = no JSON = fail
+        if (!SkipWhitespace(&data, end))
+            return false;
+
+        if (!ParseEvent(&data, end, handler, scratch))
+            return false;
+
+        // Can be white space now and should be at the end of the string then...
+        return !SkipWhitespace(&data, end);
+    }
+    catch (const JSONException &e)
+    {
+        return false;
+    }
+}
+
+/**
+ * Parses a JSON encoded value, handing its parts to the handler. Takes
+ * the same steps as JSONValue::Parse() without building the value.
+ *
+ * @access protected
+ *
+ * @param char** data Pointer to a char* that contains the JSON text
+ * @param char* end The end of the JSON text
+ * @param JSONHandler handler The handler to receive the value
+ * @param std::string scratch A buffer to unescape strings into
+ *
+ * @return bool Returns false if the handler stopped the parse, or throw
+ *              JSONException if the text is invalid
+ */
+bool JSON::ParseEvent(const char **data, const char *end, JSONHandler &handler, std::string &scratch)
+{
+    // Is it a string?
+    if (**data == '"')
+    {
+        (*data)++;
+
+        // Only strings with escapes need unescaping into the buffer
+        std::string_view view;
+        if (ExtractStringView(data, end, view))
+            return handler.String(view);
+
+        if (!ExtractString(data, end, scratch))
+            throw JSONException();
+
+        return handler.String(scratch);
+    }
+
+    // Is it a boolean?
+    else if ((end - *data >= 4 && strncasecmp(*data, "true", 4) == 0) || (end - *data >= 5 && strncasecmp(*data, "false", 5) == 0))
+    {
+        bool value = strncasecmp(*data, "true", 4) == 0;
+        (*data) += value ? 4 : 5;
+        return handler.Bool(value);
+    }
+
+    // Is it a null?
+    else if (end - *data >= 4 && strncasecmp(*data, "null", 4) == 0)
+    {
+        (*data) += 4;
+        return handler.Null();
+    }
+
+    // Is it a number?
+    else if (**data == '-' || (**data >= '0' && **data <= '9'))
+    {
+        JSONValue number = ParseNumber(data, end);
+        if (number.type == JSONType_Number)
+            return handler.Number(number.number_value);
+
+        if (number.integer_unsigned)
+            return handler.Unsigned(number.unsigned_value);
+
+        return handler.Integer(number.integer_value);
+    }
+
+    // An object?
+    else if (**data == '{')
+    {
+        if (!handler.StartObject())
+            return false;
+
+        (*data)++;
+
+        // Whitespace at the start?
+        if (!SkipWhitespace(data, end))
+            throw JSONException();
+
+        // Special case - empty object
+        if (**data == '}')
+        {
+            (*data)++;
+            return handler.EndObject();
+        }
+
+        while (true)
+        {
+            // We want a string now...
+            if (**data != '"')
+                throw JSONException();
+
+            (*data)++;
+            std::string_view name;
+            if (ExtractStringView(data, end, name))
+            {
+                if (!handler.Key(name))
+                    return false;
+            }
+            else
+            {
+                if (!ExtractString(data, end, scratch))
+                    throw JSONException();
+
+                if (!handler.Key(scratch))
+                    return false;
+            }
+
+            // More whitespace, then a : and the value
+            if (!SkipWhitespace(data, end) || *((*data)++) != ':' || !SkipWhitespace(data, end))
+                throw JSONException();
+
+            if (!ParseEvent(data, end, handler, scratch))
+                return false;
+
+            // More whitespace?
+            if (!SkipWhitespace(data, end))
+                throw JSONException();
+
+            // End of object?
+            if (**data == '}')
+            {
+                (*data)++;
+                return handler.EndObject();
+            }
+
+            // Want a , now, then whitespace before the next key
+            if (**data != ',')
+                throw JSONException();
+
+            (*data)++;
+            if (!SkipWhitespace(data, end))
+                throw JSONException();
+        }
+    }
+
+    // An array?
+    else if (**data == '[')
+    {
+        if (!handler.StartArray())
+            return false;
+
+        (*data)++;
+
+        // Whitespace at the start?
+        if (!SkipWhitespace(data, end))
+            throw JSONException();
+
+        // Special case - empty array
+        if (**data == ']')
+        {
+            (*data)++;
+            return handler.EndArray();
+        }
+
+        while (true)
+        {
+            // Get the value
+            if (!ParseEvent(data, end, handler, scratch))
+                return false;
+
+            // More whitespace?
+            if (!SkipWhitespace(data, end))
+                throw JSONException();
+
+            // End of array?
+            if (**data == ']')
+            {
+                (*data)++;
+                return handler.EndArray();
+            }
+
+            // Want a , now, then whitespace before the next value
+            if (**data != ',')
+                throw JSONException();
+
+            (*data)++;
+            if (!SkipWhitespace(data, end))
+                throw JSONException();
+        }
+    }
+
+    // Ran out of possibilites, it's bad!
+    else
+    {
         throw JSONException();
-    
-    // We're now at the end of the string
-    return value;
+    }
 }
 
 /**
@@ -88,121 +980,279 @@ std::string JSON::Stringify(const JSONValue &value)
  * @access protected
  *
  * @param char** data Pointer to a char* that contains the JSON text
+ * @param char* end The end of the JSON text
  *
  * @return bool Returns true if there is more data, or false if the end of the text was reached
  */
-bool JSON::SkipWhitespace(const char **data)
+bool JSON::SkipWhitespace(const char **data, const char *end)
 {
-    while (**data != 0 && (**data == ' ' || **data == '\t' || **data == '\r' || **data == '\n'))
+    // Runs are usually short, so step through the first few characters and
+    // only hand longer runs (e.g. deep indentation) to the vectorised scan
+    for (int i = 0; i < 8; i++)
+    {
+        if (*data == end)
+            return false;
+
+        if (**data != ' ' && **data != '\t' && **data != '\r' && **data != '\n')
+            return true;
+
         (*data)++;
-    
-    return **data != 0;
+    }
+
+    *data = simplejson_skip_whitespace(*data, end);
+    return *data != end;
 }
 
+// Writes unescaped characters back over the text they were read from, the
+// unescaped form is never longer so the writes can't overtake the reads
+struct InSituWriter
+{
+    char *out;
+
+    InSituWriter &operator+=(char chr)
+    {
+        *(out++) = chr;
+        return *this;
+    }
+
+    void append(const char *chars, size_t count)
+    {
+        memmove(out, chars, count);
+        out += count;
+    }
+};
+
 /**
- * Extracts a JSON String as defined by the spec - "<some chars>"
- * Any escaped characters are swapped out for their unescaped values
+ * Parses the 4 hex digits of a \\u escape
+ *
+ * @param char* hex The first of the hex digits
+ * @param unsigned int& value Set to the value of the digits
+ *
+ * @return bool Returns true if all 4 are valid hex digits
+ */
+static inline bool ParseHex4(const char *hex, unsigned int &value)
+{
+    value = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        char chr = hex[i];
+        value <<= 4;
+        if (chr >= '0' && chr <= '9')
+            value |= chr - '0';
+        else if (chr >= 'A' && chr <= 'F')
+            value |= 10 + (chr - 'A');
+        else if (chr >= 'a' && chr <= 'f')
+            value |= 10 + (chr - 'a');
+        else
+            return false;
+    }
+
+    return true;
+}
+
+/**
+ * Encodes a unicode code point as UTF-8
+ *
+ * @param unsigned int code_point The code point, up to 0x10FFFF
+ * @param char* utf8 Space for the 4 bytes it may take
+ *
+ * @return size_t Returns the number of bytes written
+ */
+static inline size_t EncodeUtf8(unsigned int code_point, char *utf8)
+{
+    if (code_point < 0x80)
+    {
+        utf8[0] = static_cast<char>(code_point);
+        return 1;
+    }
+    else if (code_point < 0x800)
+    {
+        utf8[0] = static_cast<char>(0xC0 | (code_point >> 6));
+        utf8[1] = static_cast<char>(0x80 | (code_point & 0x3F));
+        return 2;
+    }
+    else if (code_point < 0x10000)
+    {
+        utf8[0] = static_cast<char>(0xE0 | (code_point >> 12));
+        utf8[1] = static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+        utf8[2] = static_cast<char>(0x80 | (code_point & 0x3F));
+        return 3;
+    }
+
+    utf8[0] = static_cast<char>(0xF0 | (code_point >> 18));
+    utf8[1] = static_cast<char>(0x80 | ((code_point >> 12) & 0x3F));
+    utf8[2] = static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+    utf8[3] = static_cast<char>(0x80 | (code_point & 0x3F));
+    return 4;
+}
+
+/**
+ * Parses the 4 hex digits of a \\u escape that may be cut short by the end
+ * of the text
+ *
+ * @param char* hex The first of the hex digits
+ * @param char* end The end of the text
+ * @param unsigned int& value Set to the value of the digits
+ *
+ * @return int Returns 1 if all 4 are valid hex digits, 0 if one isn't or
+ *             -1 if the text ends before the 4th
+ */
+static inline int ParseEscapeHex(const char *hex, const char *end, unsigned int &value)
+{
+    if (end - hex >= 4)
+        return ParseHex4(hex, value) ? 1 : 0;
+
+    // Check the digits there are so that a bad one is caught straight away
+    char padded[4] = { '0', '0', '0', '0' };
+    memcpy(padded, hex, end - hex);
+    return ParseHex4(padded, value) ? -1 : 0;
+}
+
+/**
+ * Unescapes one escape sequence, e.g. n or u00e9, including the escaped
+ * low surrogate that must follow an escaped high one
+ *
+ * @param char* data The character after the backslash
+ * @param char* end The end of the text
+ * @param char* utf8 Space for the up to 4 unescaped characters
+ * @param size_t& utf8_size Set to the number of unescaped characters
+ *
+ * @return int Returns how many characters after the backslash the sequence
+ *             took, 0 if it's invalid or -1 if the text ends partway through
+ */
+static inline int DecodeEscape(const char *data, const char *end, char *utf8, size_t &utf8_size)
+{
+    if (data == end)
+        return -1;
+
+    utf8_size = 1;
+    switch (*data)
+    {
+        case '"': utf8[0] = '"'; return 1;
+        case '\\': utf8[0] = '\\'; return 1;
+        case '/': utf8[0] = '/'; return 1;
+        case 'b': utf8[0] = '\b'; return 1;
+        case 'f': utf8[0] = '\f'; return 1;
+        case 'n': utf8[0] = '\n'; return 1;
+        case 'r': utf8[0] = '\r'; return 1;
+        case 't': utf8[0] = '\t'; return 1;
+        case 'u': break;
+
+        // By the spec, only the above cases are allowed
+        default: return 0;
+    }
+
+    unsigned int code_point;
+    int hex = ParseEscapeHex(data + 1, end, code_point);
+    if (hex <= 0)
+        return hex;
+
+    int taken = 5;
+
+    // A high surrogate must be followed by an escaped low one
+    if (code_point >= 0xD800 && code_point <= 0xDBFF)
+    {
+        const char *low = data + 5;
+        if ((low < end && low[0] != '\\') || (low + 1 < end && low[1] != 'u'))
+            return 0;
+        if (end - low < 2)
+            return -1;
+
+        unsigned int low_surrogate;
+        hex = ParseEscapeHex(low + 2, end, low_surrogate);
+        if (hex <= 0)
+            return hex;
+        if (low_surrogate < 0xDC00 || low_surrogate > 0xDFFF)
+            return 0;
+
+        code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low_surrogate - 0xDC00);
+        taken = 11;
+    }
+    else if (code_point >= 0xDC00 && code_point <= 0xDFFF)
+    {
+        // Lone low surrogate
+        return 0;
+    }
+
+    utf8_size = EncodeUtf8(code_point, utf8);
+    return taken;
+}
+
+/**
+ * Unescapes one escape sequence, for parsers that read a string in parts
  *
  * @access protected
  *
+ * @param char* data The character after the backslash
+ * @param char* end The end of the text
+ * @param char* utf8 Space for the up to 4 unescaped characters
+ * @param size_t& utf8_size Set to the number of unescaped characters
+ *
+ * @return int Returns how many characters after the backslash the sequence
+ *             took, 0 if it's invalid or -1 if the text ends partway through
+ */
+int JSON::UnescapeSequence(const char *data, const char *end, char *utf8, size_t &utf8_size)
+{
+    return DecodeEscape(data, end, utf8, utf8_size);
+}
+
+/**
+ * Unescapes the rest of a JSON String as defined by the spec - <some chars>"
+ * Any escaped characters are swapped out for their unescaped values
+ *
  * @param char** data Pointer to a char* that contains the JSON text
- * @param std::string& str Reference to a std::string to receive the extracted string
+ * @param char* end The end of the JSON text
+ * @param Output& str The output to append the unescaped characters to with
+ *                    += and append()
  *
  * @return bool Returns true on success, false on failure
  */
-bool JSON::ExtractString(const char **data, std::string &str)
+template <class Output>
+static bool UnescapeString(const char **data, const char *end, Output &str)
 {
-    str = "";
-    
-    while (**data != 0)
+    while (*data < end)
     {
-        // Save the char so we can change it if need be
+        // Copy the run of plain characters up to the next quote, escape or
+        // control character in one go
+        const char *run_end = simplejson_find_escape(*data, end);
+        if (run_end != *data)
+        {
+            str.append(*data, run_end - *data);
+            *data = run_end;
+            continue;
+        }
+
+        // What stopped the run
         char next_char = **data;
         
         // Escaping something?
         if (next_char == '\\')
         {
-            // Move over the escape char
-            (*data)++;
-            
-            // Deal with the escaped char
-            switch (**data)
-            {
-                case '"': next_char = '"'; break;
-                case '\\': next_char = '\\'; break;
-                case '/': next_char = '/'; break;
-                case 'b': next_char = '\b'; break;
-                case 'f': next_char = '\f'; break;
-                case 'n': next_char = '\n'; break;
-                case 'r': next_char = '\r'; break;
-                case 't': next_char = '\t'; break;
-                case 'u':
-                {
-                    (*data)--;
+            char utf8[4];
+            size_t utf8_size;
+            int taken = DecodeEscape(*data + 1, end, utf8, utf8_size);
+            if (taken <= 0)
+                return false;
 
-                    std::u16string unicode_chars;
-                    while (**data == '\\' && *((*data)+1) == 'u')
-                    {
-                        (*data)++;
-
-                        // We need 5 chars (4 hex + the 'u') or its not valid
-                        if (!simplejson_strnlen(*data, 5))
-                            return false;
-                        
-                        // Deal with the chars
-                        char16_t unicode_char = 0;
-                        for (int i = 0; i < 4; i++)
-					    {
-                            // Do it first to move off the 'u' and leave us on the
-                            // final hex digit as we move on by one later on
-                            (*data)++;
-
-                            unicode_char <<= 4;
-
-                            // Parse the hex digit
-                            if (**data >= '0' && **data <= '9')
-                                unicode_char |= (**data - '0');
-                            else if (**data >= 'A' && **data <= 'F')
-                                unicode_char |= (10 + (**data - 'A'));
-                            else if (**data >= 'a' && **data <= 'f')
-                                unicode_char |= (10 + (**data - 'a'));
-                            else
-                            {
-                                // Invalid hex digit = invalid JSON
-                                return false;
-                            }
-                        }
-                        unicode_chars += unicode_char;
-                        (*data)++;
-                    }
-                    (*data)--;
-
-                    std::wstring_convert<deletable_facet<
-                        std::codecvt<char16_t, char, std::mbstate_t>>,
-                                         char16_t> convert;
-                    std::string utf8_chars = convert.to_bytes(unicode_chars);
-                    // If failed to parse utf-16, give up
-                    if (utf8_chars.size() == 0) return false;
-                    for (size_t i = 0; i < utf8_chars.size()-1; i++)
-                        str += utf8_chars[i];
-                    next_char = *utf8_chars.rbegin();
-                    
-                    break;
-                }
-                
-                // By the spec, only the above cases are allowed
-                default:
-                    return false;
-            }
+            // The UTF-8 is never longer than the escape it came from,
+            // which in situ parsing relies on
+            str.append(utf8, utf8_size);
+            *data += 1 + taken;
+            continue;
         }
         
         // End of the string?
-        else if (next_char == '"')
+        if (next_char == '"')
         {
             (*data)++;
-            str.reserve(); // Remove unused capacity
             return true;
         }
+
+        // Other control characters are let through, but a NULL never is
+        else if (next_char == 0)
+        {
+            return false;
+        }
         
         // Add the next char
         str += next_char;
@@ -216,41 +1266,403 @@ bool JSON::ExtractString(const char **data, std::string &str)
 }
 
 /**
- * Parses some text as though it is an integer
+ * Extracts a JSON String as defined by the spec - "<some chars>"
+ * Any escaped characters are swapped out for their unescaped values
  *
  * @access protected
  *
  * @param char** data Pointer to a char* that contains the JSON text
+ * @param char* end The end of the JSON text
+ * @param std::string& str Reference to a std::string to receive the extracted string
  *
- * @return double Returns the double value of the number found
+ * @return bool Returns true on success, false on failure
  */
-double JSON::ParseInt(const char **data)
+bool JSON::ExtractString(const char **data, const char *end, std::string &str)
 {
-    double integer = 0;
-    while (**data != 0 && **data >= '0' && **data <= '9')
-        integer = integer * 10 + (*(*data)++ - '0');
-    
-    return integer;
+    str = "";
+    return UnescapeString(data, end, str);
+}
+
+/**
+ * Extracts a JSON String as defined by the spec - "<some chars>", unescaping
+ * it in place. Only for text handed to ParseInSitu(), which is writable.
+ *
+ * @access protected
+ *
+ * @param char** data Pointer to a char* that contains the JSON text
+ * @param char* end The end of the JSON text
+ * @param std::string_view& str Reference to a std::string_view to receive the
+ *                              unescaped string, which lives in the text
+ *
+ * @return bool Returns true on success, false on failure
+ */
+bool JSON::ExtractStringInSitu(const char **data, const char *end, std::string_view &str)
+{
+    char *start = const_cast<char *>(*data);
+    InSituWriter writer = { start };
+    if (!UnescapeString(data, end, writer))
+        return false;
+
+    str = std::string_view(start, writer.out - start);
+    return true;
+}
+
+/**
+ * Finds a JSON String that contains no escapes - "<some chars>"
+ * The string is left untouched if it does contain escapes, so that it can
+ * be handed to ExtractString() instead.
+ *
+ * @access protected
+ *
+ * @param char** data Pointer to a char* that contains the JSON text
+ * @param char* end The end of the JSON text
+ * @param std::string_view& str Reference to a std::string_view to receive the string
+ *
+ * @return bool Returns true if the string was found without escapes, false otherwise
+ */
+bool JSON::ExtractStringView(const char **data, const char *end, std::string_view &str)
+{
+    // Control characters are let through as ExtractString() does
+    const char *quote = simplejson_find_escape(*data, end);
+    while (quote != end && *quote != '"' && *quote != '\\' && *quote != 0)
+        quote = simplejson_find_escape(quote + 1, end);
+
+    // Escaped or never closed, let ExtractString() sort it out
+    if (quote == end || *quote != '"')
+        return false;
+
+    str = std::string_view(*data, quote - *data);
+    *data = quote + 1;
+    return true;
+}
+
+/**
+ * Skips over the rest of a JSON String - <some chars>" - checking its
+ * escapes as ExtractString() would but without unescaping anything
+ *
+ * @access protected
+ *
+ * @param char** data Pointer to a char* that contains the JSON text
+ * @param char* end The end of the JSON text
+ *
+ * @return bool Returns true on success, false on an invalid or unclosed string
+ */
+bool JSON::SkipString(const char **data, const char *end)
+{
+    const char *ptr = *data;
+    while ((ptr = simplejson_find_escape(ptr, end)) != end)
+    {
+        if (*ptr == '"')
+        {
+            *data = ptr + 1;
+            return true;
+        }
+
+        // Other control characters are let through, but a NULL never is
+        if (*ptr == 0)
+            return false;
+
+        if (*(ptr++) != '\\')
+            continue;
+
+        if (ptr == end)
+            return false;
+
+        switch (*(ptr++))
+        {
+            case '"': case '\\': case '/': case 'b': case 'f': case 'n': case 'r': case 't':
+                break;
+
+            case 'u':
+            {
+                unsigned int code_point;
+                if (end - ptr < 4 || !ParseHex4(ptr, code_point))
+                    return false;
+                ptr += 4;
+
+                // A high surrogate must be followed by an escaped low one
+                if (code_point >= 0xD800 && code_point <= 0xDBFF)
+                {
+                    unsigned int low_surrogate;
+                    if (end - ptr < 6 || ptr[0] != '\\' || ptr[1] != 'u' || !ParseHex4(ptr + 2, low_surrogate) ||
+                        low_surrogate < 0xDC00 || low_surrogate > 0xDFFF)
+                        return false;
+                    ptr += 6;
+                }
+                else if (code_point >= 0xDC00 && code_point <= 0xDFFF)
+                {
+                    return false;
+                }
+                break;
+            }
+
+            default:
+                return false;
+        }
+    }
+
+    return false;
+}
+
+// Digits are read 8 at a time where an unaligned little endian load works
+#if defined(__GNUC__) && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define SIMPLEJSON_EIGHT_DIGITS
+
+typedef std::uint64_t __attribute__((may_alias, aligned(1))) unaligned_uint64;
+
+/**
+ * Parses the next 8 characters if there are 8 left and they are all digits
+ *
+ * @param char* ptr The text to parse
+ * @param char* end The end of the text
+ * @param uint32_t& value Set to the value of the 8 digits
+ *
+ * @return bool Returns true if all 8 characters were digits
+ */
+static inline bool ParseEightDigits(const char *ptr, const char *end, std::uint32_t &value)
+{
+    if (end - ptr < 8)
+        return false;
+
+    std::uint64_t chars = *reinterpret_cast<const unaligned_uint64 *>(ptr);
+    if (((chars & 0xF0F0F0F0F0F0F0F0ull) | (((chars + 0x0606060606060606ull) & 0xF0F0F0F0F0F0F0F0ull) >> 4)) !=
+        0x3333333333333333ull)
+        return false;
+
+    // Combine pairs of digits, then pairs of those, then the two halves
+    chars -= 0x3030303030303030ull;
+    chars = chars * 10 + (chars >> 8);
+    chars = (((chars & 0x000000FF000000FFull) * 0x000F424000000064ull) +
+             (((chars >> 16) & 0x000000FF000000FFull) * 0x0000271000000001ull)) >> 32;
+    value = static_cast<std::uint32_t>(chars);
+    return true;
+}
+#endif
+
+/**
+ * Checks there is a digit at ptr
+ *
+ * @param char* ptr The character to check
+ * @param char* end The end of the text
+ *
+ * @return bool Returns true if ptr is before the end and is a digit
+ */
+static inline bool IsDigit(const char *ptr, const char *end)
+{
+    return ptr < end && static_cast<unsigned char>(*ptr - '0') < 10;
+}
+
+/**
+ * Parses a run of digits, adding them on to the end of an integer
+ *
+ * @param char* ptr The first of the digits
+ * @param char* end The end of the text
+ * @param uint64_t& mantissa The integer to add the digits to
+ *
+ * @return char* Returns the first character that isn't a digit, or end
+ */
+static inline const char *ParseDigits(const char *ptr, const char *end, std::uint64_t &mantissa)
+{
+#ifdef SIMPLEJSON_EIGHT_DIGITS
+    std::uint32_t eight_digits;
+    while (ParseEightDigits(ptr, end, eight_digits))
+    {
+        mantissa = mantissa * 100000000 + eight_digits;
+        ptr += 8;
+    }
+
+    // With 8 characters left one of them wasn't a digit, so the run ends
+    // before the text does
+    if (end - ptr >= 8)
+    {
+        while (static_cast<unsigned char>(*ptr - '0') < 10)
+            mantissa = mantissa * 10 + (*ptr++ - '0');
+
+        return ptr;
+    }
+#endif
+    while (IsDigit(ptr, end))
+        mantissa = mantissa * 10 + (*ptr++ - '0');
+
+    return ptr;
+}
+
+/**
+ * Parses a JSON number as defined by the spec - -?int(.digits)?([eE][+-]?digits)?
+ * Integers that fit in 64 bits are kept exact, anything else is correctly
+ * rounded to a double, the same as strtod() gives
+ *
+ * @access protected
+ *
+ * @param char** data Pointer to a char* that contains the JSON text
+ * @param char* end The end of the JSON text
+ *
+ * @return JSONValue Returns the Integer or Number found,
+ *         or throw JSONException on invalid number
+ */
+JSONValue JSON::ParseNumber(const char **data, const char *end)
+{
+    const char *start = *data;
+    const char *ptr = start;
+
+    bool neg = ptr < end && *ptr == '-';
+    if (neg) ptr++;
+
+    // Gather all the digits into one integer and the power of ten it needs
+    // scaling by. Past 19 digits the integer may overflow, that's checked later.
+    std::uint64_t mantissa = 0;
+    int exponent = 0;
+    const char *digits_start = ptr;
+
+    // Parse the whole part of the number - a leading 0 must be on its own
+    if (ptr < end && *ptr == '0')
+        ptr++;
+    else if (IsDigit(ptr, end))
+    {
+        ptr = ParseDigits(ptr, end, mantissa);
+    }
+    else
+        throw JSONException();
+    int digit_count = static_cast<int>(ptr - digits_start);
+    bool integer = true;
+
+    // Could be a decimal now...
+    if (ptr < end && *ptr == '.')
+    {
+        ptr++;
+        integer = false;
+
+        const char *fraction_start = ptr;
+        ptr = ParseDigits(ptr, end, mantissa);
+
+        // Not get any digits?
+        if (ptr == fraction_start)
+            throw JSONException();
+
+        exponent = -static_cast<int>(ptr - fraction_start);
+        digit_count += static_cast<int>(ptr - fraction_start);
+    }
+
+    // Could be an exponent now...
+    if (ptr < end && (*ptr == 'E' || *ptr == 'e'))
+    {
+        ptr++;
+        integer = false;
+
+        // Check signage of expo
+        bool neg_expo = false;
+        if (ptr < end && (*ptr == '-' || *ptr == '+'))
+        {
+            neg_expo = *ptr == '-';
+            ptr++;
+        }
+
+        // Not get any digits?
+        if (!IsDigit(ptr, end))
+            throw JSONException();
+
+        // Anything this big is out of range anyway, so stop before it overflows
+        int expo = 0;
+        while (IsDigit(ptr, end))
+        {
+            if (expo < 100000)
+                expo = expo * 10 + (*ptr - '0');
+            ptr++;
+        }
+        exponent += neg_expo ? -expo : expo;
+    }
+
+    *data = ptr;
+
+    // Integers are exact in up to 19 digits, or 20 if they still fit in a
+    // uint64_t. -0 has to stay a double to keep its sign.
+    if (integer && !(neg && mantissa == 0))
+    {
+        bool fits = digit_count <= 19 ||
+            (digit_count == 20 && !neg && std::from_chars(digits_start, ptr, mantissa).ec == std::errc());
+
+        if (fits && !neg)
+            return JSONValue(mantissa);
+        else if (fits && mantissa <= (std::uint64_t(1) << 63))
+            return JSONValue(mantissa == (std::uint64_t(1) << 63) ? INT64_MIN : -static_cast<std::int64_t>(mantissa));
+    }
+
+    // Leading zeros don't count towards the 19 digits that always fit
+    if (digit_count > 19)
+    {
+        for (const char *digit = digits_start; digit < ptr && (*digit == '0' || *digit == '.'); digit++)
+            digit_count -= *digit == '0';
+    }
+
+    double number;
+    if (digit_count <= 19 && simplejson_decimal_to_double(mantissa, exponent, neg, number))
+        return JSONValue(number);
+
+    // Too many digits, or too close to call, so convert the text exactly
+    std::from_chars_result result = std::from_chars(start, ptr, number);
+    if (result.ec == std::errc::result_out_of_range)
+    {
+        // Overflow gives infinity, underflow gives zero, as strtod() does
+        number = digit_count + exponent > 0 ? HUGE_VAL : 0.0;
+        if (neg) number = -number;
+    }
+    else if (result.ec != std::errc() || result.ptr != ptr)
+        throw JSONException();
+
+    return JSONValue(number);
 }
 
 /**
- * Parses some text as though it is a decimal
+ * Skips over a JSON number, checking it against the spec without
+ * converting it
  *
  * @access protected
  *
  * @param char** data Pointer to a char* that contains the JSON text
+ * @param char* end The end of the JSON text
  *
- * @return double Returns the double value of the decimal found
+ * @return bool Returns true on success, false on invalid number
  */
-double JSON::ParseDecimal(const char **data)
+bool JSON::SkipNumber(const char **data, const char *end)
 {
-    double decimal = 0.0;
-    double factor = 0.1;
-    while (**data != 0 && **data >= '0' && **data <= '9')
+    const char *ptr = *data;
+
+    if (ptr < end && *ptr == '-')
+        ptr++;
+
+    // The whole part - a leading 0 must be on its own
+    if (ptr < end && *ptr == '0')
+        ptr++;
+    else if (IsDigit(ptr, end))
+    {
+        while (IsDigit(ptr, end))
+            ptr++;
+    }
+    else
+        return false;
+
+    // Could be a decimal now...
+    if (ptr < end && *ptr == '.')
     {
-        int digit = (*(*data)++ - '0');
-        decimal = decimal + digit * factor;
-        factor *= 0.1;
+        ptr++;
+        if (!IsDigit(ptr, end))
+            return false;
+        while (IsDigit(ptr, end))
+            ptr++;
     }
-    return decimal;
+
+    // Could be an exponent now...
+    if (ptr < end && (*ptr == 'E' || *ptr == 'e'))
+    {
+        ptr++;
+        if (ptr < end && (*ptr == '-' || *ptr == '+'))
+            ptr++;
+        if (!IsDigit(ptr, end))
+            return false;
+        while (IsDigit(ptr, end))
+            ptr++;
+    }
+
+    *data = ptr;
+    return true;
 }
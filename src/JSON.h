@@ -27,30 +27,63 @@
 
 #include <vector>
 #include <string>
+#include <string_view>
 #include <map>
 #include <stdexcept>
+#include <functional>
 
 #include <cstring>
 #include <cstdlib>
 
-// Simple function to check a string 's' has at least 'n' characters
-static inline bool simplejson_strnlen(const char *s, size_t n) {
-	if (s == 0)
-        return false;
-
-    const char *save = s;
-    while (n-- > 0)
-    {
-        if (*(save++) == 0) return false;
-    }
-
-    return true;
-}
+#include "JSONArena.h"
+#include "JSONFlatMap.h"
+#include "JSONHandler.h"
 
 // Custom types
 class JSONValue;
-typedef std::vector<JSONValue> JSONArray;
-typedef std::map<std::string, JSONValue> JSONObject;
+typedef std::vector<JSONValue, JSONAllocator<JSONValue> > JSONArray;
+#ifdef SIMPLEJSON_SORTED_OBJECTS
+// Objects that iterate (and stringify) their keys sorted
+typedef std::map<std::string, JSONValue, std::less<>,
+                 JSONAllocator<std::pair<const std::string, JSONValue> > > JSONObject;
+#else
+// Objects keep their keys in the order they were parsed / added
+typedef JSONFlatMap<JSONValue, JSONAllocator<std::pair<JSONKey, JSONValue> > > JSONObject;
+#endif
+
+// Options for Parse(data, length), ParseView and ParseInSitu, combined with |
+enum JSONParseFlags
+{
+    JSONParse_Default = 0,
+
+    // Numbers are only checked while parsing and keep referring to their
+    // text. They are converted each time they're read, and stringified
+    // unchanged. Only for ParseView and ParseInSitu.
+    JSONParse_LazyNumbers = 1,
+
+    // Where the CPU has SSE2 or AVX2, the structural characters are found
+    // up front and walked rather than reading the text character by
+    // character. Quicker for indented or deeply nested text, slower for
+    // text that's mostly long strings. In situ parses ignore it.
+    JSONParse_Indexed = 2
+};
+
+// Internal state threaded through a single parse
+struct JSONParseContext
+{
+    JSONArena *arena = 0;
+    bool borrow_strings = false;
+    bool in_situ = false;
+    bool lazy_numbers = false;
+    bool indexed = false;
+    std::string scratch;
+
+    // Object keys are interned in here when set, and the most recent ones
+    // are remembered by hash
+    JSONKeyPool *keys = 0;
+    static const std::size_t key_cache_size = 32;
+    JSONKey key_cache[key_cache_size];
+};
 
 class JSONException : public std::runtime_error
 {
@@ -64,15 +97,39 @@ public:
 class JSON
 {
     friend class JSONValue;
+    friend class JSONReader;
     
     public:
+        class IncrementalParser;
+
         static JSONValue Parse(const std::string &data);
+        static JSONValue Parse(const char *data, size_t length, int flags = JSONParse_Default);
+        static JSONValue Parse(const std::string &data, JSONArena &arena);
+        static JSONValue Parse(const std::string &data, JSONKeyPool &keys);
+        static JSONValue Parse(const std::string &data, JSONArena &arena, JSONKeyPool &keys);
+        static JSONValue ParseView(const char *data, int flags = JSONParse_Default);
+        static JSONValue ParseView(const char *data, JSONArena &arena, int flags = JSONParse_Default);
+        static JSONValue ParseInSitu(char *buf, size_t len, int flags = JSONParse_Default);
+        static JSONValue ParseInSitu(char *buf, size_t len, JSONArena &arena, int flags = JSONParse_Default);
+        static JSONValue ParseParallel(const std::string &data, unsigned int threads = 0);
+        static std::vector<JSONValue> ParseLines(const std::string &data, unsigned int threads = 0);
+        static void ParseLines(const std::string &data, const std::function<void(size_t, JSONValue &&)> &callback,
+                               unsigned int threads = 0);
+        static bool ParseEvents(const char *data, JSONHandler &handler);
+        static bool ParseEvents(const char *data, size_t length, JSONHandler &handler);
         static std::string Stringify(const JSONValue &value);
     protected:
-        static bool SkipWhitespace(const char **data);
-        static bool ExtractString(const char **data, std::string &str);
-        static double ParseInt(const char **data);
-        static double ParseDecimal(const char **data);
+        static JSONValue ParseDocument(const char *data, const char *end, JSONParseContext &context);
+        static bool ParseEvent(const char **data, const char *end, JSONHandler &handler, std::string &scratch);
+        static JSONValue ParseInSituDocument(char *buf, size_t len, JSONParseContext &context);
+        static bool SkipWhitespace(const char **data, const char *end);
+        static bool ExtractString(const char **data, const char *end, std::string &str);
+        static bool ExtractStringView(const char **data, const char *end, std::string_view &str);
+        static bool ExtractStringInSitu(const char **data, const char *end, std::string_view &str);
+        static int UnescapeSequence(const char *data, const char *end, char *utf8, size_t &utf8_size);
+        static JSONValue ParseNumber(const char **data, const char *end);
+        static bool SkipNumber(const char **data, const char *end);
+        static bool SkipString(const char **data, const char *end);
     private:
         JSON() = default;
 };
@@ -0,0 +1,130 @@
+/*
+ * File JSONArena.cpp part of the SimpleJSON Library - http://mjpa.in/json
+ *
+ * Copyright (C) 2010 Mike Anchor
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <cstdint>
+#include <new>
+
+#include "JSONArena.h"
+
+/**
+ * Basic constructor for creating an empty arena
+ * No memory is allocated until the first allocation
+ *
+ * @access public
+ *
+ * @param size_t m_block_size The size of each block requested from the heap
+ */
+JSONArena::JSONArena(std::size_t m_block_size)
+{
+    block_size = m_block_size;
+    first_block = 0;
+    active_block = 0;
+    current = 0;
+    limit = 0;
+}
+
+/**
+ * The destructor for the arena, returns every block to the heap
+ *
+ * @access public
+ */
+JSONArena::~JSONArena()
+{
+    while (first_block != 0)
+    {
+        Block *next = first_block->next;
+        ::operator delete(first_block);
+        first_block = next;
+    }
+}
+
+/**
+ * Allocates memory from the arena
+ *
+ * @access public
+ *
+ * @param size_t size The number of bytes required
+ * @param size_t alignment The required alignment, a power of 2
+ *
+ * @return void* Returns the memory, which stays valid until Reset()
+ */
+void *JSONArena::Allocate(std::size_t size, std::size_t alignment)
+{
+    std::uintptr_t ptr = (reinterpret_cast<std::uintptr_t>(current) + alignment - 1) & ~(alignment - 1);
+    if (current == 0 || ptr + size > reinterpret_cast<std::uintptr_t>(limit))
+    {
+        NextBlock(size + alignment);
+        ptr = (reinterpret_cast<std::uintptr_t>(current) + alignment - 1) & ~(alignment - 1);
+    }
+
+    current = reinterpret_cast<char *>(ptr + size);
+    return reinterpret_cast<void *>(ptr);
+}
+
+/**
+ * Releases everything allocated so far, keeping the blocks for reuse
+ *
+ * @access public
+ */
+void JSONArena::Reset()
+{
+    active_block = first_block;
+    if (active_block != 0)
+    {
+        current = reinterpret_cast<char *>(active_block) + block_header_size;
+        limit = current + active_block->size;
+    }
+}
+
+/**
+ * Moves on to a block with at least the given space, reusing blocks that
+ * were kept by Reset() where possible
+ *
+ * @access private
+ *
+ * @param size_t min_size The number of bytes the block must hold
+ */
+void JSONArena::NextBlock(std::size_t min_size)
+{
+    Block *next = active_block != 0 ? active_block->next : first_block;
+
+    if (next == 0 || next->size < min_size)
+    {
+        std::size_t size = min_size > block_size ? min_size : block_size;
+        Block *block = static_cast<Block *>(::operator new(block_header_size + size));
+        block->size = size;
+        block->next = next;
+
+        if (active_block != 0)
+            active_block->next = block;
+        else
+            first_block = block;
+
+        next = block;
+    }
+
+    active_block = next;
+    current = reinterpret_cast<char *>(active_block) + block_header_size;
+    limit = current + active_block->size;
+}
@@ -0,0 +1,116 @@
+/*
+ * File JSONArena.h part of the SimpleJSON Library - http://mjpa.in/json
+ *
+ * Copyright (C) 2010 Mike Anchor
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef _JSONARENA_H_
+#define _JSONARENA_H_
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+
+// A bump allocator that hands out memory from large blocks and frees it
+// all at once. Values parsed into an arena must be destroyed before the
+// arena is Reset() or destroyed.
+class JSONArena
+{
+    public:
+        JSONArena(std::size_t m_block_size = 64 * 1024);
+        ~JSONArena();
+
+        void *Allocate(std::size_t size, std::size_t alignment);
+        void Reset();
+
+    private:
+        JSONArena(const JSONArena &) = delete;
+        JSONArena &operator=(const JSONArena &) = delete;
+
+        struct Block
+        {
+            Block *next;
+            std::size_t size;
+        };
+
+        // Block headers are padded so the data after them is suitably aligned
+        static constexpr std::size_t block_header_size =
+            (sizeof(Block) + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+
+        void NextBlock(std::size_t min_size);
+
+        std::size_t block_size;
+        Block *first_block;
+        Block *active_block;
+        char *current;
+        char *limit;
+};
+
+// Standard allocator adaptor for the library containers, uses the heap
+// when no arena is given. Copies of a container always go to the heap.
+template <class T>
+class JSONAllocator
+{
+    public:
+        typedef T value_type;
+        typedef std::false_type propagate_on_container_copy_assignment;
+        typedef std::true_type propagate_on_container_move_assignment;
+        typedef std::true_type propagate_on_container_swap;
+
+        JSONAllocator() : arena(0) {}
+        JSONAllocator(JSONArena *m_arena) : arena(m_arena) {}
+        template <class U> JSONAllocator(const JSONAllocator<U> &other) : arena(other.arena) {}
+
+        T *allocate(std::size_t n)
+        {
+            if (arena != 0)
+                return static_cast<T *>(arena->Allocate(n * sizeof(T), alignof(T)));
+            return static_cast<T *>(::operator new(n * sizeof(T)));
+        }
+
+        void deallocate(T *p, std::size_t)
+        {
+            // Arena memory is only released as a whole
+            if (arena == 0)
+                ::operator delete(p);
+        }
+
+        JSONAllocator select_on_container_copy_construction() const
+        {
+            return JSONAllocator();
+        }
+
+        JSONArena *arena;
+};
+
+template <class T, class U>
+inline bool operator==(const JSONAllocator<T> &a, const JSONAllocator<U> &b)
+{
+    return a.arena == b.arena;
+}
+
+template <class T, class U>
+inline bool operator!=(const JSONAllocator<T> &a, const JSONAllocator<U> &b)
+{
+    return a.arena != b.arena;
+}
+
+#endif
@@ -0,0 +1,386 @@
+/*
+ * File JSONFlatMap.h part of the SimpleJSON Library - http://mjpa.in/json
+ *
+ * Copyright (C) 2010 Mike Anchor
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef _JSONFLATMAP_H_
+#define _JSONFLATMAP_H_
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "JSONKey.h"
+
+// A map from strings to T that keeps its entries in one contiguous vector
+// in the order they were added, used as JSONObject. Small maps are searched
+// linearly, bigger ones also get a power of 2 sized table of indices into
+// the vector that is probed linearly. Lookups take anything that converts
+// to a std::string_view, so they never allocate, or a JSONKey, which skips
+// comparing the text when both keys are interned in the same JSONKeyPool.
+// Keys must not be changed through an iterator.
+template <class T, class Allocator = std::allocator<std::pair<JSONKey, T> > >
+class JSONFlatMap
+{
+    public:
+        typedef JSONKey key_type;
+        typedef T mapped_type;
+        typedef std::pair<JSONKey, T> value_type;
+        typedef Allocator allocator_type;
+        typedef std::size_t size_type;
+
+        static_assert(std::is_same<typename Allocator::value_type, value_type>::value,
+                      "JSONFlatMap's allocator must allocate its std::pair<JSONKey, T> entries");
+
+    private:
+        typedef std::allocator_traits<Allocator> allocator_traits;
+        typedef typename allocator_traits::template rebind_alloc<value_type> entry_allocator;
+        typedef typename allocator_traits::template rebind_alloc<std::uint64_t> slot_allocator;
+        typedef std::vector<value_type, entry_allocator> entry_vector;
+
+    public:
+        typedef typename entry_vector::iterator iterator;
+        typedef typename entry_vector::const_iterator const_iterator;
+
+        JSONFlatMap() : slots(0), slot_count(0) {}
+
+        explicit JSONFlatMap(const Allocator &allocator)
+            : entries(entry_allocator(allocator)), slots(0), slot_count(0) {}
+
+        JSONFlatMap(const JSONFlatMap &other)
+            : entries(other.entries), slots(0), slot_count(0)
+        {
+            BuildIndex(0);
+        }
+
+        JSONFlatMap(JSONFlatMap &&other) noexcept
+            : entries(std::move(other.entries)), slots(other.slots), slot_count(other.slot_count)
+        {
+            other.slots = 0;
+            other.slot_count = 0;
+        }
+
+        ~JSONFlatMap()
+        {
+            FreeSlots();
+        }
+
+        JSONFlatMap &operator=(const JSONFlatMap &other)
+        {
+            if (this != &other)
+            {
+                entries = other.entries;
+                BuildIndex(0);
+            }
+            return *this;
+        }
+
+        JSONFlatMap &operator=(JSONFlatMap &&other) noexcept
+        {
+            if (this != &other)
+            {
+                // The entries only change hands when the allocators match,
+                // otherwise they're moved one by one and need a new table
+                bool same_allocator = entries.get_allocator() == other.entries.get_allocator();
+                FreeSlots();
+                entries = std::move(other.entries);
+                if (same_allocator)
+                {
+                    slots = other.slots;
+                    slot_count = other.slot_count;
+                    other.slots = 0;
+                    other.slot_count = 0;
+                }
+                else
+                {
+                    BuildIndex(0);
+                }
+            }
+            return *this;
+        }
+
+        allocator_type get_allocator() const { return allocator_type(entries.get_allocator()); }
+
+        iterator begin() { return entries.begin(); }
+        iterator end() { return entries.end(); }
+        const_iterator begin() const { return entries.begin(); }
+        const_iterator end() const { return entries.end(); }
+        const_iterator cbegin() const { return entries.begin(); }
+        const_iterator cend() const { return entries.end(); }
+
+        bool empty() const { return entries.empty(); }
+        size_type size() const { return entries.size(); }
+
+        template <class K>
+        iterator find(const K &key)
+        {
+            std::size_t index = FindIndex(LookupKey(key));
+            return index == not_found ? entries.end() : entries.begin() + index;
+        }
+
+        template <class K>
+        const_iterator find(const K &key) const
+        {
+            std::size_t index = FindIndex(LookupKey(key));
+            return index == not_found ? entries.end() : entries.begin() + index;
+        }
+
+        template <class K>
+        size_type count(const K &key) const
+        {
+            return FindIndex(LookupKey(key)) == not_found ? 0 : 1;
+        }
+
+        template <class K>
+        T &at(const K &key)
+        {
+            iterator it = find(key);
+            if (it == end())
+                throw std::out_of_range("JSONFlatMap::at");
+            return it->second;
+        }
+
+        template <class K>
+        const T &at(const K &key) const
+        {
+            const_iterator it = find(key);
+            if (it == end())
+                throw std::out_of_range("JSONFlatMap::at");
+            return it->second;
+        }
+
+        T &operator[](const JSONKey &key) { return TryEmplace(key).first->second; }
+        T &operator[](JSONKey &&key) { return TryEmplace(std::move(key)).first->second; }
+
+        std::pair<iterator, bool> insert(const value_type &value)
+        {
+            std::pair<iterator, bool> result = TryEmplace(value.first);
+            if (result.second)
+                result.first->second = value.second;
+            return result;
+        }
+
+        template <class K, class V>
+        std::pair<iterator, bool> emplace(K &&key, V &&value)
+        {
+            std::pair<iterator, bool> result = TryEmplace(JSONKey(std::forward<K>(key)));
+            if (result.second)
+                result.first->second = T(std::forward<V>(value));
+            return result;
+        }
+
+        iterator erase(const_iterator pos)
+        {
+            // The indices after pos all change, so the table is rebuilt
+            iterator next = entries.erase(pos);
+            if (slots != 0)
+                BuildIndex(0);
+            return next;
+        }
+
+        iterator erase(iterator pos)
+        {
+            return erase(const_iterator(pos));
+        }
+
+        template <class K>
+        size_type erase(const K &key)
+        {
+            const_iterator it = find(key);
+            if (it == cend())
+                return 0;
+            erase(it);
+            return 1;
+        }
+
+        void clear()
+        {
+            entries.clear();
+            if (slots != 0)
+                memset(slots, 0, slot_count * sizeof(std::uint64_t));
+        }
+
+        void reserve(size_type count)
+        {
+            entries.reserve(count);
+            if (count > small_size && count * 4 > slot_count * 3)
+                BuildIndex(count);
+        }
+
+        void swap(JSONFlatMap &other) noexcept
+        {
+            entries.swap(other.entries);
+            std::swap(slots, other.slots);
+            std::swap(slot_count, other.slot_count);
+        }
+
+    private:
+        static const std::size_t not_found = ~std::size_t(0);
+
+        // Maps up to this size have no table, comparing a few keys is
+        // quicker than hashing one
+        static const std::size_t small_size = 8;
+
+        // Slots hold the top 32 bits of the key's hash and the entry index
+        // plus 1, a 0 slot is empty
+        static std::uint64_t MakeSlot(std::size_t hash, std::size_t index)
+        {
+            return (static_cast<std::uint64_t>(hash) & 0xFFFFFFFF00000000ull) | (index + 1);
+        }
+
+        // Keys are searched for as JSONKeys or as plain text
+        static const JSONKey &LookupKey(const JSONKey &key) { return key; }
+
+        template <class K>
+        static std::string_view LookupKey(const K &key) { return std::string_view(key); }
+
+        static bool SameKey(const JSONKey &entry, const JSONKey &key) { return entry == key; }
+
+        static bool SameKey(const JSONKey &entry, std::string_view key)
+        {
+            return entry.size() == key.size() && memcmp(entry.data(), key.data(), key.size()) == 0;
+        }
+
+        static std::size_t Hash(std::string_view key) { return Mix(std::hash<std::string_view>()(key)); }
+        static std::size_t Hash(const JSONKey &key) { return Mix(key.Hash()); }
+
+        // Mix the bits so the low ones used for the slot are well spread
+        static std::size_t Mix(std::uint64_t hash)
+        {
+            hash ^= hash >> 29;
+            hash *= 0xBF58476D1CE4E5B9ull;
+            hash ^= hash >> 32;
+            return static_cast<std::size_t>(hash);
+        }
+
+        // The smallest table that holds count entries at 3/4 load
+        static std::size_t SlotsFor(std::size_t count)
+        {
+            std::size_t needed = 8;
+            while (needed * 3 < count * 4)
+                needed *= 2;
+            return needed;
+        }
+
+        template <class Key>
+        std::size_t FindIndex(const Key &key) const
+        {
+            if (slots == 0)
+            {
+                for (std::size_t index = 0; index < entries.size(); index++)
+                {
+                    if (SameKey(entries[index].first, key))
+                        return index;
+                }
+                return not_found;
+            }
+
+            return FindIndex(key, Hash(key));
+        }
+
+        template <class Key>
+        std::size_t FindIndex(const Key &key, std::size_t hash) const
+        {
+            std::uint64_t fragment = static_cast<std::uint64_t>(hash) & 0xFFFFFFFF00000000ull;
+            std::size_t mask = slot_count - 1;
+            for (std::size_t slot = hash & mask; slots[slot] != 0; slot = (slot + 1) & mask)
+            {
+                if ((slots[slot] & 0xFFFFFFFF00000000ull) != fragment)
+                    continue;
+
+                std::size_t index = static_cast<std::size_t>(slots[slot] & 0xFFFFFFFFull) - 1;
+                if (SameKey(entries[index].first, key))
+                    return index;
+            }
+
+            return not_found;
+        }
+
+        void PlaceSlot(std::size_t hash, std::size_t index)
+        {
+            std::size_t mask = slot_count - 1;
+            std::size_t slot = hash & mask;
+            while (slots[slot] != 0)
+                slot = (slot + 1) & mask;
+            slots[slot] = MakeSlot(hash, index);
+        }
+
+        template <class K>
+        std::pair<iterator, bool> TryEmplace(K &&key)
+        {
+            std::size_t index = FindIndex(static_cast<const JSONKey &>(key));
+            if (index != not_found)
+                return std::pair<iterator, bool>(entries.begin() + index, false);
+
+            entries.emplace_back(std::forward<K>(key), T());
+            if (slots != 0 && entries.size() * 4 <= slot_count * 3)
+                PlaceSlot(Hash(entries.back().first), entries.size() - 1);
+            else if (entries.size() > small_size)
+                BuildIndex(0);
+
+            return std::pair<iterator, bool>(entries.end() - 1, true);
+        }
+
+        void FreeSlots()
+        {
+            if (slots != 0)
+            {
+                slot_allocator allocator(entries.get_allocator());
+                std::allocator_traits<slot_allocator>::deallocate(allocator, slots, slot_count);
+                slots = 0;
+                slot_count = 0;
+            }
+        }
+
+        // Rebuilds the table big enough for the given number of entries (or
+        // the current ones if more), small maps are left without one
+        void BuildIndex(std::size_t count)
+        {
+            FreeSlots();
+            if (count < entries.size())
+                count = entries.size();
+            if (count <= small_size)
+                return;
+
+            slot_count = SlotsFor(count);
+
+            slot_allocator allocator(entries.get_allocator());
+            slots = std::allocator_traits<slot_allocator>::allocate(allocator, slot_count);
+            memset(slots, 0, slot_count * sizeof(std::uint64_t));
+
+            for (std::size_t i = 0; i < entries.size(); i++)
+                PlaceSlot(Hash(entries[i].first), i);
+        }
+
+        entry_vector entries;
+        std::uint64_t *slots;
+        std::size_t slot_count;
+};
+
+#endif
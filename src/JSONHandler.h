@@ -0,0 +1,58 @@
+/*
+ * File JSONHandler.h part of the SimpleJSON Library - http://mjpa.in/json
+ *
+ * Copyright (C) 2010 Mike Anchor
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef _JSONHANDLER_H_
+#define _JSONHANDLER_H_
+
+#include <cstdint>
+#include <string_view>
+
+// Receives the parts of a document from JSON::ParseEvents() in order, with
+// no JSONValue tree built. Strings and keys are only valid during the call.
+// Each method returns false to stop the parse, by default they do nothing.
+class JSONHandler
+{
+    public:
+        virtual ~JSONHandler() {}
+
+        virtual bool Null() { return true; }
+        virtual bool Bool(bool value) { (void)value; return true; }
+        virtual bool Number(double value) { (void)value; return true; }
+
+        // Numbers without a fraction or exponent that fit 64 bits, those
+        // above INT64_MAX come as Unsigned(). Both default to Number().
+        virtual bool Integer(std::int64_t value) { return Number(static_cast<double>(value)); }
+        virtual bool Unsigned(std::uint64_t value) { return Number(static_cast<double>(value)); }
+
+        virtual bool String(std::string_view value) { (void)value; return true; }
+
+        virtual bool StartObject() { return true; }
+        virtual bool Key(std::string_view name) { (void)name; return true; }
+        virtual bool EndObject() { return true; }
+
+        virtual bool StartArray() { return true; }
+        virtual bool EndArray() { return true; }
+};
+
+#endif
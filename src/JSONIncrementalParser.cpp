@@ -0,0 +1,523 @@
+/*
+ * File JSONIncrementalParser.cpp part of the SimpleJSON Library - http://mjpa.in/json
+ *
+ * Copyright (C) 2010 Mike Anchor
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "JSONIncrementalParser.h"
+#include "JSONSimd.h"
+
+// The characters that can appear in a number or a true/false/null
+static inline bool IsNumberChar(char chr)
+{
+    return (chr >= '0' && chr <= '9') || chr == '-' || chr == '+' || chr == '.' || chr == 'e' || chr == 'E';
+}
+
+static inline bool IsLiteralChar(char chr)
+{
+    return (chr >= 'a' && chr <= 'z') || (chr >= 'A' && chr <= 'Z');
+}
+
+/**
+ * Incremental parser constructor, ready for the first chunk
+ *
+ * @access public
+ */
+JSON::IncrementalParser::IncrementalParser()
+{
+    Reset();
+}
+
+/**
+ * Parses the next chunk of the document
+ *
+ * @access public
+ *
+ * @param char* data The chunk, which needn't be NULL terminated
+ * @param size_t length The length of the chunk
+ *
+ * @return bool Returns false if the text so far isn't valid JSON
+ */
+bool JSON::IncrementalParser::Feed(const char *data, size_t length)
+{
+    const char *end = data + length;
+
+    try
+    {
+        while (data < end && state != State_Error)
+        {
+            // Carry on with a token the last chunk ended in
+            if (state == State_String)
+            {
+                data = ReadString(data, end);
+                continue;
+            }
+            else if (state == State_Number)
+            {
+                data = ReadNumber(data, end);
+                continue;
+            }
+            else if (state == State_Literal)
+            {
+                data = ReadLiteral(data, end);
+                continue;
+            }
+
+            // Anything else can have whitespace first
+            if (*data == ' ' || *data == '\t' || *data == '\r' || *data == '\n')
+            {
+                data++;
+                continue;
+            }
+
+            switch (state)
+            {
+                // Special case - empty array
+                case State_FirstValue:
+                    if (*data == ']')
+                    {
+                        data++;
+                        EndContainer();
+                        break;
+                    }
+                    data = StartValue(data, end);
+                    break;
+
+                case State_Value:
+                    data = StartValue(data, end);
+                    break;
+
+                // Special case - empty object
+                case State_FirstKey:
+                    if (*data == '}')
+                    {
+                        data++;
+                        EndContainer();
+                        break;
+                    }
+                    // Fall through
+
+                // We want a string now...
+                case State_Key:
+                    if (*data != '"')
+                        throw JSONException();
+
+                    string_is_key = true;
+                    data = ReadString(data + 1, end);
+                    break;
+
+                // Need a : now
+                case State_Colon:
+                    if (*(data++) != ':')
+                        throw JSONException();
+
+                    state = State_Value;
+                    break;
+
+                // Want a , or the end of the object or array
+                case State_Next:
+                    if (*data == (frames.back().object ? '}' : ']'))
+                    {
+                        data++;
+                        EndContainer();
+                    }
+                    else if (*(data++) == ',')
+                        state = frames.back().object ? State_Key : State_Value;
+                    else
+                        throw JSONException();
+                    break;
+
+                // Only whitespace can follow the document
+                default:
+                    throw JSONException();
+            }
+        }
+    }
+    catch (const JSONException &e)
+    {
+        state = State_Error;
+    }
+
+    return state != State_Error;
+}
+
+/**
+ * Ends the document, returning it and resetting the parser for another
+ *
+ * @access public
+ *
+ * @return JSONValue Returns the document or throw JSONException if the text
+ *         wasn't a complete and valid JSON document
+ */
+JSONValue JSON::IncrementalParser::Finish()
+{
+    try
+    {
+        // A number or literal at the top level ends with the text
+        if (state == State_Number)
+            EndNumber(token.data(), token.size());
+        else if (state == State_Literal)
+            EndLiteral(token);
+    }
+    catch (const JSONException &e)
+    {
+        state = State_Error;
+    }
+
+    if (state != State_Done)
+    {
+        Reset();
+        throw JSONException();
+    }
+
+    JSONValue result = std::move(document);
+    Reset();
+    return result;
+}
+
+/**
+ * Forgets the document so far
+ *
+ * @access private
+ */
+void JSON::IncrementalParser::Reset()
+{
+    state = State_Value;
+    frames.clear();
+    document = JSONValue();
+    token.clear();
+    escape.clear();
+    string_is_key = false;
+    escape_pending = false;
+}
+
+/**
+ * Starts reading the value at the start of the text
+ *
+ * @access private
+ *
+ * @param char* data The first character of the value
+ * @param char* end The end of the chunk
+ *
+ * @return char* Returns where to carry on reading, or throw JSONException
+ *         if no value starts there
+ */
+const char *JSON::IncrementalParser::StartValue(const char *data, const char *end)
+{
+    if (*data == '"')
+    {
+        string_is_key = false;
+        return ReadString(data + 1, end);
+    }
+    else if (*data == '-' || (*data >= '0' && *data <= '9'))
+    {
+        return ReadNumber(data, end);
+    }
+    else if (IsLiteralChar(*data))
+    {
+        return ReadLiteral(data, end);
+    }
+    else if (*data == '{' || *data == '[')
+    {
+        frames.emplace_back();
+        frames.back().object = *data == '{';
+        state = frames.back().object ? State_FirstKey : State_FirstValue;
+        return data + 1;
+    }
+
+    // Ran out of possibilites, it's bad!
+    throw JSONException();
+}
+
+/**
+ * Reads the rest of a string, or as much of it as the chunk has
+ *
+ * @access private
+ *
+ * @param char* data The text after the opening quote or the end of the last chunk
+ * @param char* end The end of the chunk
+ *
+ * @return char* Returns where to carry on reading, or throw JSONException
+ *         on an invalid string
+ */
+const char *JSON::IncrementalParser::ReadString(const char *data, const char *end)
+{
+    if (state != State_String)
+    {
+        state = State_String;
+        escape_pending = false;
+        token.clear();
+    }
+
+    // The last chunk ended partway through an escape, which is only a few
+    // characters long so it's finished a character at a time
+    while (escape_pending && data < end)
+    {
+        escape += *(data++);
+        if (AppendEscape(escape.data(), escape.data() + escape.size()) > 0)
+            escape_pending = false;
+    }
+
+    const char *run = data;
+    while (data < end)
+    {
+        const char *special = simplejson_find_escape(data, end);
+        if (special == end)
+            break;
+
+        if (*special == '"')
+        {
+            // A string that is all in this chunk with no escapes needs no copy
+            if (token.empty())
+            {
+                EndString(std::string_view(run, special - run));
+            }
+            else
+            {
+                token.append(run, special - run);
+                EndString(token);
+            }
+            return special + 1;
+        }
+
+        // Escapes are unescaped as they're read, one the chunk ends partway
+        // through is kept until the next
+        if (*special == '\\')
+        {
+            token.append(run, special - run);
+            int taken = AppendEscape(special + 1, end);
+            if (taken < 0)
+            {
+                escape.assign(special + 1, end);
+                escape_pending = true;
+                return end;
+            }
+
+            data = run = special + 1 + taken;
+            continue;
+        }
+
+        // Control characters are let through, bar NULLs, as ExtractString() does
+        if (*special == 0)
+            throw JSONException();
+
+        data = special + 1;
+    }
+
+    token.append(run, end - run);
+    return end;
+}
+
+/**
+ * Unescapes an escape sequence onto the string read so far
+ *
+ * @access private
+ *
+ * @param char* data The character after the backslash
+ * @param char* end The end of the text
+ *
+ * @return int Returns how many characters after the backslash the sequence
+ *             took, -1 if the text ends partway through it, or throw
+ *             JSONException if it's invalid
+ */
+int JSON::IncrementalParser::AppendEscape(const char *data, const char *end)
+{
+    char utf8[4];
+    size_t utf8_size;
+    int taken = UnescapeSequence(data, end, utf8, utf8_size);
+    if (taken == 0)
+        throw JSONException();
+
+    if (taken > 0)
+        token.append(utf8, utf8_size);
+
+    return taken;
+}
+
+/**
+ * Reads the rest of a number, or as much of it as the chunk has
+ *
+ * @access private
+ *
+ * @param char* data The start of the number or the end of the last chunk
+ * @param char* end The end of the chunk
+ *
+ * @return char* Returns where to carry on reading, or throw JSONException
+ *         on an invalid number
+ */
+const char *JSON::IncrementalParser::ReadNumber(const char *data, const char *end)
+{
+    const char *start = data;
+    while (data < end && IsNumberChar(*data))
+        data++;
+
+    // A number that is all in this chunk is parsed where it is, the
+    // character after it stops the parse before the end of the chunk
+    if (data < end && state != State_Number)
+    {
+        EndNumber(start, data - start);
+        return data;
+    }
+
+    if (state != State_Number)
+    {
+        state = State_Number;
+        token.clear();
+    }
+
+    token.append(start, data - start);
+    if (data < end)
+        EndNumber(token.data(), token.size());
+
+    return data;
+}
+
+/**
+ * Reads the rest of a true, false or null, or as much of it as the chunk has
+ *
+ * @access private
+ *
+ * @param char* data The start of the literal or the end of the last chunk
+ * @param char* end The end of the chunk
+ *
+ * @return char* Returns where to carry on reading, or throw JSONException
+ *         if it isn't a literal
+ */
+const char *JSON::IncrementalParser::ReadLiteral(const char *data, const char *end)
+{
+    const char *start = data;
+    while (data < end && IsLiteralChar(*data))
+        data++;
+
+    if (data < end && state != State_Literal)
+    {
+        EndLiteral(std::string_view(start, data - start));
+        return data;
+    }
+
+    if (state != State_Literal)
+    {
+        state = State_Literal;
+        token.clear();
+    }
+
+    token.append(start, data - start);
+    if (data < end)
+        EndLiteral(token);
+
+    return data;
+}
+
+/**
+ * Adds a string that has been read
+ *
+ * @access private
+ *
+ * @param std::string_view text The unescaped string, without quotes
+ */
+void JSON::IncrementalParser::EndString(std::string_view text)
+{
+    if (string_is_key)
+    {
+        frames.back().key = JSONObject::key_type(text);
+        state = State_Colon;
+    }
+    else
+    {
+        AddValue(JSONValue(std::string(text)));
+    }
+}
+
+/**
+ * Adds a number that has been read
+ *
+ * @access private
+ *
+ * @param char* text The number
+ * @param size_t length The length of the number
+ */
+void JSON::IncrementalParser::EndNumber(const char *text, size_t length)
+{
+    const char *end = text + length;
+    JSONValue number = ParseNumber(&text, end);
+    if (text != end)
+        throw JSONException();
+
+    AddValue(std::move(number));
+}
+
+/**
+ * Adds a true, false or null that has been read
+ *
+ * @access private
+ *
+ * @param std::string_view text The literal
+ */
+void JSON::IncrementalParser::EndLiteral(std::string_view text)
+{
+    if (text.size() == 4 && strncasecmp(text.data(), "true", 4) == 0)
+        AddValue(JSONValue(true));
+    else if (text.size() == 5 && strncasecmp(text.data(), "false", 5) == 0)
+        AddValue(JSONValue(false));
+    else if (text.size() == 4 && strncasecmp(text.data(), "null", 4) == 0)
+        AddValue(JSONValue());
+    else
+        throw JSONException();
+}
+
+/**
+ * Closes the innermost object or array, adding it to its parent
+ *
+ * @access private
+ */
+void JSON::IncrementalParser::EndContainer()
+{
+    Frame &frame = frames.back();
+    JSONValue value = frame.object ? JSONValue(std::move(frame.members)) : JSONValue(std::move(frame.array));
+    frames.pop_back();
+    AddValue(std::move(value));
+}
+
+/**
+ * Adds a value to the innermost object or array, or makes it the
+ * document if it's the top level value
+ *
+ * @access private
+ *
+ * @param JSONValue value The value to add
+ */
+void JSON::IncrementalParser::AddValue(JSONValue &&value)
+{
+    if (frames.empty())
+    {
+        document = std::move(value);
+        state = State_Done;
+        return;
+    }
+
+    Frame &frame = frames.back();
+    if (frame.object)
+        frame.members[std::move(frame.key)] = std::move(value);
+    else
+        frame.array.push_back(std::move(value));
+
+    state = State_Next;
+}
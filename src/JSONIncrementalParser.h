@@ -0,0 +1,91 @@
+/*
+ * File JSONIncrementalParser.h part of the SimpleJSON Library - http://mjpa.in/json
+ *
+ * Copyright (C) 2010 Mike Anchor
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef _JSONINCREMENTALPARSER_H_
+#define _JSONINCREMENTALPARSER_H_
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "JSON.h"
+
+// Parses a document handed over in chunks of any size, e.g. as they arrive
+// from a socket. Each Feed() carries on from where the last one stopped
+// rather than reading the text again, and strings are unescaped as they're
+// read; only a token split between chunks is copied.
+// Finish() returns the document and leaves the parser ready for the next.
+class JSON::IncrementalParser
+{
+    public:
+        IncrementalParser();
+
+        bool Feed(const char *data, size_t length);
+        JSONValue Finish();
+
+        bool HasError() const { return state == State_Error; }
+
+    private:
+        // What the parser wants next, the last four are partway through a token
+        enum State { State_Value, State_FirstValue, State_FirstKey, State_Key, State_Colon, State_Next,
+                     State_Done, State_Error, State_String, State_Number, State_Literal };
+
+        // An object or array that is still open
+        struct Frame
+        {
+            bool object;
+            JSONArray array;
+            JSONObject members;
+            JSONObject::key_type key;
+        };
+
+        void Reset();
+        const char *StartValue(const char *data, const char *end);
+        const char *ReadString(const char *data, const char *end);
+        int AppendEscape(const char *data, const char *end);
+        const char *ReadNumber(const char *data, const char *end);
+        const char *ReadLiteral(const char *data, const char *end);
+        void EndString(std::string_view text);
+        void EndNumber(const char *text, size_t length);
+        void EndLiteral(std::string_view text);
+        void EndContainer();
+        void AddValue(JSONValue &&value);
+
+        State state;
+        std::vector<Frame> frames;
+        JSONValue document;
+
+        // The part of a token read so far when a chunk ends partway through
+        // it, and for strings whether it's a key. Strings are kept unescaped,
+        // and any escapes are unescaped onto them here as they're read.
+        std::string token;
+        bool string_is_key;
+
+        // The part of an escape, after the backslash, when a chunk ends
+        // partway through it
+        std::string escape;
+        bool escape_pending;
+};
+
+#endif
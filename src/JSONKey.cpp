@@ -0,0 +1,240 @@
+/*
+ * File JSONKey.cpp part of the SimpleJSON Library - http://mjpa.in/json
+ *
+ * Copyright (C) 2010 Mike Anchor
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <functional>
+#include <limits>
+#include <new>
+#include <stdexcept>
+
+#include "JSONKey.h"
+
+/**
+ * Points the key at text held elsewhere
+ *
+ * @access private
+ *
+ * @param char* pointer The NULL terminated text
+ * @param size_t length The length of the text
+ * @param unsigned char kind Either kind_heap or kind_interned
+ */
+void JSONKey::SetPointer(const char *pointer, std::size_t length, unsigned char kind)
+{
+    if (length > UINT32_MAX)
+        throw std::length_error("JSONKey");
+
+    std::uint32_t length32 = static_cast<std::uint32_t>(length);
+    memset(storage, 0, sizeof(storage));
+    memcpy(storage, &pointer, sizeof(pointer));
+    memcpy(storage + sizeof(pointer), &length32, sizeof(length32));
+    storage[tag_byte] = static_cast<char>(kind);
+}
+
+/**
+ * Sets the key to a copy of the given text, inline if it's short enough
+ *
+ * @access private
+ *
+ * @param std::string_view text The text of the key
+ */
+void JSONKey::Assign(std::string_view text)
+{
+    if (text.size() <= max_inline)
+    {
+        if (!text.empty())
+            memcpy(storage, text.data(), text.size());
+        memset(storage + text.size(), 0, tag_byte - text.size());
+        storage[tag_byte] = static_cast<char>(text.size());
+        return;
+    }
+
+    char *copy = new char[text.size() + 1];
+    memcpy(copy, text.data(), text.size());
+    copy[text.size()] = 0;
+    SetPointer(copy, text.size(), kind_heap);
+}
+
+/**
+ * Retrieves the hash of the key's text
+ *
+ * @access public
+ *
+ * @return size_t Returns std::hash of the text as a std::string_view
+ */
+std::size_t JSONKey::Hash() const
+{
+    if (IsInterned())
+        return InternedHeader()->hash;
+
+    return std::hash<std::string_view>()(view());
+}
+
+/**
+ * JSONKeyPool constructor
+ *
+ * @access public
+ */
+JSONKeyPool::JSONKeyPool()
+{
+}
+
+/**
+ * JSONKeyPool destructor, the interned text is freed with the shard arenas
+ *
+ * @access public
+ */
+JSONKeyPool::~JSONKeyPool()
+{
+}
+
+/**
+ * Interns a key, adding it to the pool if it isn't there yet
+ *
+ * @access public
+ *
+ * @param std::string_view text The text of the key
+ *
+ * @return JSONKey Returns a key referring to the pool's copy of the text
+ */
+JSONKey JSONKeyPool::Intern(std::string_view text)
+{
+    return Intern(text, std::hash<std::string_view>()(text));
+}
+
+/**
+ * Interns a key whose hash is already known
+ *
+ * @access public
+ *
+ * @param std::string_view text The text of the key
+ * @param size_t hash std::hash of the text as a std::string_view
+ *
+ * @return JSONKey Returns a key referring to the pool's copy of the text
+ */
+JSONKey JSONKeyPool::Intern(std::string_view text, std::size_t hash)
+{
+    // The top bits pick the shard, the bottom ones the slot within it
+    Shard &shard = shards[(hash >> (std::numeric_limits<std::size_t>::digits - 4)) % shard_count];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    const JSONKey::Header *header = Find(shard, text, hash);
+    if (header == 0)
+    {
+        if ((shard.count + 1) * 4 > shard.slots.size() * 3)
+        {
+            std::vector<const JSONKey::Header *> old_slots(shard.slots.size() ? shard.slots.size() * 2 : 64);
+            old_slots.swap(shard.slots);
+            for (std::size_t i = 0; i < old_slots.size(); i++)
+            {
+                if (old_slots[i] != 0)
+                    Place(shard, old_slots[i]);
+            }
+        }
+
+        if (text.size() > UINT32_MAX)
+            throw std::length_error("JSONKeyPool");
+
+        void *memory = shard.arena.Allocate(sizeof(JSONKey::Header) + text.size() + 1, alignof(JSONKey::Header));
+        JSONKey::Header *added = new (memory) JSONKey::Header;
+        added->pool = this;
+        added->hash = hash;
+        added->size = static_cast<std::uint32_t>(text.size());
+
+        char *copy = reinterpret_cast<char *>(added + 1);
+        memcpy(copy, text.data(), text.size());
+        copy[text.size()] = 0;
+
+        Place(shard, added);
+        shard.count++;
+        header = added;
+    }
+
+    JSONKey key;
+    key.SetPointer(reinterpret_cast<const char *>(header + 1), header->size, JSONKey::kind_interned);
+    return key;
+}
+
+/**
+ * Counts the keys in the pool
+ *
+ * @access public
+ *
+ * @return size_t Returns the number of different keys interned
+ */
+std::size_t JSONKeyPool::Size() const
+{
+    std::size_t size = 0;
+    for (std::size_t i = 0; i < shard_count; i++)
+    {
+        std::lock_guard<std::mutex> lock(shards[i].mutex);
+        size += shards[i].count;
+    }
+
+    return size;
+}
+
+/**
+ * Looks up a key in a shard, which must be locked
+ *
+ * @access private
+ *
+ * @param Shard shard The shard to search
+ * @param std::string_view text The text of the key
+ * @param size_t hash std::hash of the text
+ *
+ * @return JSONKey::Header* Returns the key's header, or NULL if it isn't there
+ */
+const JSONKey::Header *JSONKeyPool::Find(const Shard &shard, std::string_view text, std::size_t hash)
+{
+    if (shard.slots.empty())
+        return 0;
+
+    std::size_t mask = shard.slots.size() - 1;
+    for (std::size_t slot = hash & mask; shard.slots[slot] != 0; slot = (slot + 1) & mask)
+    {
+        const JSONKey::Header *header = shard.slots[slot];
+        if (header->hash == hash && header->size == text.size() &&
+            memcmp(header + 1, text.data(), text.size()) == 0)
+            return header;
+    }
+
+    return 0;
+}
+
+/**
+ * Adds a key to the first free slot of a shard, which must be locked
+ *
+ * @access private
+ *
+ * @param Shard shard The shard to add to
+ * @param JSONKey::Header* header The key's header
+ */
+void JSONKeyPool::Place(Shard &shard, const JSONKey::Header *header)
+{
+    std::size_t mask = shard.slots.size() - 1;
+    std::size_t slot = header->hash & mask;
+    while (shard.slots[slot] != 0)
+        slot = (slot + 1) & mask;
+
+    shard.slots[slot] = header;
+}
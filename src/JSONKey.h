@@ -0,0 +1,261 @@
+/*
+ * File JSONKey.h part of the SimpleJSON Library - http://mjpa.in/json
+ *
+ * Copyright (C) 2010 Mike Anchor
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef _JSONKEY_H_
+#define _JSONKEY_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+#include <mutex>
+
+#include "JSONArena.h"
+
+class JSONKeyPool;
+
+// The key of a JSONFlatMap entry, 16 bytes. Keys of up to 14 characters are
+// held inline, longer ones are copied to the heap, and keys interned in a
+// JSONKeyPool just refer to the pool's copy. Two keys interned in the same
+// pool are equal only if they are the same pointer.
+class JSONKey
+{
+    template <class S>
+    using IfStringLike = typename std::enable_if<std::is_convertible<const S &, std::string_view>::value &&
+                                                 !std::is_same<S, JSONKey>::value>::type;
+
+    public:
+        JSONKey() { Assign(std::string_view()); }
+        JSONKey(const char *text) { Assign(std::string_view(text)); }
+        JSONKey(const std::string &text) { Assign(std::string_view(text)); }
+        JSONKey(std::string_view text) { Assign(text); }
+
+        JSONKey(const JSONKey &other)
+        {
+            if (other.Kind() == kind_heap)
+                Assign(other.view());
+            else
+                memcpy(storage, other.storage, sizeof(storage));
+        }
+
+        JSONKey(JSONKey &&other) noexcept
+        {
+            memcpy(storage, other.storage, sizeof(storage));
+            other.storage[0] = 0;
+            other.storage[tag_byte] = 0;
+        }
+
+        ~JSONKey() { Release(); }
+
+        JSONKey &operator=(const JSONKey &other)
+        {
+            if (this != &other)
+            {
+                JSONKey copy(other);
+                swap(copy);
+            }
+            return *this;
+        }
+
+        JSONKey &operator=(JSONKey &&other) noexcept
+        {
+            if (this != &other)
+            {
+                Release();
+                memcpy(storage, other.storage, sizeof(storage));
+                other.storage[0] = 0;
+                other.storage[tag_byte] = 0;
+            }
+            return *this;
+        }
+
+        void swap(JSONKey &other) noexcept
+        {
+            char temp[sizeof(storage)];
+            memcpy(temp, storage, sizeof(storage));
+            memcpy(storage, other.storage, sizeof(storage));
+            memcpy(other.storage, temp, sizeof(storage));
+        }
+
+        // The same accessors as std::string, the text is always NULL terminated
+        const char *data() const { return Kind() == kind_inline ? storage : Pointer(); }
+        const char *c_str() const { return data(); }
+        std::size_t size() const;
+        std::size_t length() const { return size(); }
+        bool empty() const { return size() == 0; }
+        std::string_view view() const { return std::string_view(data(), size()); }
+        std::string str() const { return std::string(data(), size()); }
+        operator std::string_view() const { return view(); }
+
+        // Keys were std::strings before, so code that copies them into one
+        // (e.g. std::string name = it->first) still works
+        operator std::string() const { return str(); }
+
+        bool IsInterned() const { return Kind() == kind_interned; }
+
+        // std::hash of the text, stored with interned keys
+        std::size_t Hash() const;
+
+        friend bool operator==(const JSONKey &a, const JSONKey &b);
+        friend bool operator!=(const JSONKey &a, const JSONKey &b) { return !(a == b); }
+
+        // Compared with the text of anything string-like, without making a
+        // JSONKey of it first, and ordered as std::string keys were
+        template <class S, class = IfStringLike<S> >
+        friend bool operator==(const JSONKey &a, const S &b) { return a.view() == std::string_view(b); }
+        template <class S, class = IfStringLike<S> >
+        friend bool operator==(const S &a, const JSONKey &b) { return std::string_view(a) == b.view(); }
+        template <class S, class = IfStringLike<S> >
+        friend bool operator!=(const JSONKey &a, const S &b) { return !(a == b); }
+        template <class S, class = IfStringLike<S> >
+        friend bool operator!=(const S &a, const JSONKey &b) { return !(a == b); }
+        friend bool operator<(const JSONKey &a, const JSONKey &b) { return a.view() < b.view(); }
+        template <class S, class = IfStringLike<S> >
+        friend bool operator<(const JSONKey &a, const S &b) { return a.view() < std::string_view(b); }
+        template <class S, class = IfStringLike<S> >
+        friend bool operator<(const S &a, const JSONKey &b) { return std::string_view(a) < b.view(); }
+
+    private:
+        friend class JSONKeyPool;
+
+        // Stored before the text of each interned key
+        struct Header
+        {
+            const JSONKeyPool *pool;
+            std::size_t hash;
+            std::uint32_t size;
+        };
+
+        // The last byte tells the kinds apart, it holds the length of an
+        // inline key. Pointer keys keep the pointer then a 32 bit length.
+        static const std::size_t tag_byte = 15;
+        static const std::size_t max_inline = 14;
+        static const unsigned char kind_inline = 0x00;
+        static const unsigned char kind_heap = 0x40;
+        static const unsigned char kind_interned = 0x80;
+
+        unsigned char Kind() const { return static_cast<unsigned char>(storage[tag_byte]) & 0xC0; }
+
+        const char *Pointer() const
+        {
+            const char *pointer;
+            memcpy(&pointer, storage, sizeof(pointer));
+            return pointer;
+        }
+
+        const Header *InternedHeader() const
+        {
+            return reinterpret_cast<const Header *>(Pointer() - sizeof(Header));
+        }
+
+        void SetPointer(const char *pointer, std::size_t length, unsigned char kind);
+        void Assign(std::string_view text);
+        void Release()
+        {
+            if (Kind() == kind_heap)
+                delete[] Pointer();
+        }
+
+        alignas(8) char storage[16];
+};
+
+// A thread safe set of interned keys shared by many documents, see
+// JSON::Parse(data, keys). Interned keys stay valid until the pool is
+// destroyed, so it must outlive every value parsed with it.
+class JSONKeyPool
+{
+    public:
+        JSONKeyPool();
+        ~JSONKeyPool();
+
+        JSONKey Intern(std::string_view text);
+        JSONKey Intern(std::string_view text, std::size_t hash);
+        std::size_t Size() const;
+
+    private:
+        JSONKeyPool(const JSONKeyPool &) = delete;
+        JSONKeyPool &operator=(const JSONKeyPool &) = delete;
+
+        // Keys are spread over shards by hash, each with its own lock
+        static const std::size_t shard_count = 16;
+
+        struct Shard
+        {
+            Shard() : arena(4096) {}
+
+            mutable std::mutex mutex;
+            JSONArena arena;
+            std::vector<const JSONKey::Header *> slots;
+            std::size_t count = 0;
+        };
+
+        static const JSONKey::Header *Find(const Shard &shard, std::string_view text, std::size_t hash);
+        static void Place(Shard &shard, const JSONKey::Header *header);
+
+        Shard shards[shard_count];
+};
+
+/**
+ * Retrieves the length of the key
+ *
+ * @access public
+ *
+ * @return size_t Returns the number of characters, not counting the NULL
+ */
+inline std::size_t JSONKey::size() const
+{
+    if (Kind() == kind_inline)
+        return static_cast<unsigned char>(storage[tag_byte]);
+
+    std::uint32_t length;
+    memcpy(&length, storage + sizeof(const char *), sizeof(length));
+    return length;
+}
+
+/**
+ * Compares two keys, keys interned in the same pool are compared by pointer
+ *
+ * @param JSONKey a The first key
+ * @param JSONKey b The second key
+ *
+ * @return bool Returns true if the keys have the same text
+ */
+inline bool operator==(const JSONKey &a, const JSONKey &b)
+{
+    if (a.IsInterned() && b.IsInterned())
+    {
+        if (a.Pointer() == b.Pointer())
+            return true;
+        if (a.InternedHeader()->pool == b.InternedHeader()->pool)
+            return false;
+    }
+
+    std::size_t size = a.size();
+    return size == b.size() && memcmp(a.data(), b.data(), size) == 0;
+}
+
+#endif
@@ -0,0 +1,43 @@
+/*
+ * File JSONNumber.h part of the SimpleJSON Library - http://mjpa.in/json
+ *
+ * Copyright (C) 2010 Mike Anchor
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef _JSONNUMBER_H_
+#define _JSONNUMBER_H_
+
+#include <cstdint>
+
+// Converts mantissa * 10^exponent to the nearest double, as strtod() would.
+// Returns false in the rare cases it can't be sure of the rounding, when the
+// caller should fall back to an exact conversion of the text.
+bool simplejson_decimal_to_double(std::uint64_t mantissa, int exponent, bool negative, double &value);
+
+// The most characters simplejson_format_double() writes
+#define SIMPLEJSON_DOUBLE_CHARS 32
+
+// Writes the shortest text that parses back to exactly the same double,
+// returning the end of it. Whole numbers below 2^53 are written without an
+// exponent. The value must be finite.
+char *simplejson_format_double(double value, char *out);
+
+#endif
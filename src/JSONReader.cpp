@@ -0,0 +1,345 @@
+/*
+ * File JSONReader.cpp part of the SimpleJSON Library - http://mjpa.in/json
+ *
+ * Copyright (C) 2010 Mike Anchor
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "JSONReader.h"
+
+/**
+ * Reader constructor, Next() must be called to read the first token
+ *
+ * @access public
+ *
+ * @param char* data The NULL terminated JSON text, which must outlive the reader
+ */
+JSONReader::JSONReader(const char *data)
+    : JSONReader(data, strlen(data))
+{
+}
+
+/**
+ * Reader constructor for text of a known length, which needn't be NULL
+ * terminated. Next() must be called to read the first token.
+ *
+ * @access public
+ *
+ * @param char* data The JSON text, which must outlive the reader
+ * @param size_t length The length of the JSON text
+ */
+JSONReader::JSONReader(const char *data, size_t length)
+    : data(data), data_end(data + length), token_start(data), token(JSONToken_None), bool_value(false)
+{
+}
+
+/**
+ * Moves to the next token of the document
+ *
+ * @access public
+ *
+ * @return bool Returns true if there is a token, false at the end of the
+ *              document or if the text is invalid (see HasError())
+ */
+bool JSONReader::Next()
+{
+    if (token == JSONToken_End || token == JSONToken_Error)
+        return false;
+
+    try
+    {
+        ReadToken();
+    }
+    catch (const JSONException &e)
+    {
+        token = JSONToken_Error;
+    }
+
+    return token != JSONToken_End && token != JSONToken_Error;
+}
+
+/**
+ * Skips the value the current token starts, a whole object or array if
+ * it's the start of one, or the value of a key. The skipped text is still
+ * checked, and afterwards the current token is the last token of the value.
+ *
+ * @access public
+ *
+ * @return bool Returns false if the text is invalid or the document has ended
+ */
+bool JSONReader::SkipValue()
+{
+    if (token == JSONToken_Key && !Next())
+        return false;
+
+    if (token != JSONToken_StartObject && token != JSONToken_StartArray)
+        return token != JSONToken_End && token != JSONToken_Error;
+
+    JSONToken end = token == JSONToken_StartObject ? JSONToken_EndObject : JSONToken_EndArray;
+    try
+    {
+        SkipContainer();
+        token = end;
+    }
+    catch (const JSONException &e)
+    {
+        token = JSONToken_Error;
+    }
+
+    return token != JSONToken_Error;
+}
+
+/**
+ * Skips the rest of the object or array that was just opened, up to and
+ * including its closing bracket. Brackets, commas, colons and keys are
+ * checked and strings, numbers and literals are checked as they're passed
+ * over, but nothing is unescaped or converted.
+ *
+ * @access protected
+ *
+ * @return void Throws JSONException if the text is invalid
+ */
+void JSONReader::SkipContainer()
+{
+    // The opened containers are tracked on the same stack Next() uses
+    std::size_t depth = containers.size() - 1;
+    bool first = true;
+
+    while (containers.size() > depth)
+    {
+        if (!JSON::SkipWhitespace(&data, data_end))
+            throw JSONException();
+
+        bool object = containers.back() == '{';
+
+        // End of the object or array?
+        if (*data == (object ? '}' : ']'))
+        {
+            data++;
+            containers.pop_back();
+            first = false;
+            continue;
+        }
+
+        // Want a , between values, but not before the first one
+        if (!first)
+        {
+            if (*data != ',')
+                throw JSONException();
+
+            data++;
+            if (!JSON::SkipWhitespace(&data, data_end))
+                throw JSONException();
+        }
+
+        // An object's values each need a key and a :
+        if (object)
+        {
+            if (*(data++) != '"' || !JSON::SkipString(&data, data_end) || !JSON::SkipWhitespace(&data, data_end) ||
+                *(data++) != ':' || !JSON::SkipWhitespace(&data, data_end))
+                throw JSONException();
+        }
+
+        if (*data == '{' || *data == '[')
+        {
+            containers.push_back(*(data++));
+            first = true;
+            continue;
+        }
+
+        if (*data == '"')
+        {
+            data++;
+            if (!JSON::SkipString(&data, data_end))
+                throw JSONException();
+        }
+        else if (data_end - data >= 4 && (strncasecmp(data, "true", 4) == 0 || strncasecmp(data, "null", 4) == 0))
+        {
+            data += 4;
+        }
+        else if (data_end - data >= 5 && strncasecmp(data, "false", 5) == 0)
+        {
+            data += 5;
+        }
+        else if (!JSON::SkipNumber(&data, data_end))
+        {
+            throw JSONException();
+        }
+
+        first = false;
+    }
+}
+
+/**
+ * Reads the token after the current one
+ *
+ * @access protected
+ *
+ * @return void Sets token, or throws JSONException if the text is invalid
+ */
+void JSONReader::ReadToken()
+{
+    if (token == JSONToken_None)
+    {
+        // Skip any preceding whitespace, end of data = no JSON = fail
+        if (!JSON::SkipWhitespace(&data, data_end))
+            throw JSONException();
+
+        ReadValue();
+        return;
+    }
+
+    // After the top level value there should only be whitespace
+    if (containers.empty())
+    {
+        if (JSON::SkipWhitespace(&data, data_end))
+            throw JSONException();
+
+        token = JSONToken_End;
+        return;
+    }
+
+    if (!JSON::SkipWhitespace(&data, data_end))
+        throw JSONException();
+
+    bool object = containers.back() == '{';
+
+    // A key is followed by a : and its value
+    if (token == JSONToken_Key)
+    {
+        if (*(data++) != ':' || !JSON::SkipWhitespace(&data, data_end))
+            throw JSONException();
+
+        ReadValue();
+        return;
+    }
+
+    // End of the object or array?
+    if (*data == (object ? '}' : ']'))
+    {
+        data++;
+        containers.pop_back();
+        token = object ? JSONToken_EndObject : JSONToken_EndArray;
+        return;
+    }
+
+    // Want a , between values, but not before the first one
+    if (token != JSONToken_StartObject && token != JSONToken_StartArray)
+    {
+        if (*data != ',')
+            throw JSONException();
+
+        data++;
+        if (!JSON::SkipWhitespace(&data, data_end))
+            throw JSONException();
+    }
+
+    if (object)
+        ReadKey();
+    else
+        ReadValue();
+}
+
+/**
+ * Reads an object's key
+ *
+ * @access protected
+ *
+ * @return void Sets token, or throws JSONException if the text is invalid
+ */
+void JSONReader::ReadKey()
+{
+    // We want a string now...
+    if (*data != '"')
+        throw JSONException();
+
+    token_start = data++;
+    if (!JSON::ExtractStringView(&data, data_end, string_value))
+    {
+        if (!JSON::ExtractString(&data, data_end, scratch))
+            throw JSONException();
+
+        string_value = scratch;
+    }
+
+    token = JSONToken_Key;
+}
+
+/**
+ * Reads a value, or the start of one if it's an object or array
+ *
+ * @access protected
+ *
+ * @return void Sets token, or throws JSONException if the text is invalid
+ */
+void JSONReader::ReadValue()
+{
+    token_start = data;
+
+    // Is it a string?
+    if (*data == '"')
+    {
+        data++;
+        if (!JSON::ExtractStringView(&data, data_end, string_value))
+        {
+            if (!JSON::ExtractString(&data, data_end, scratch))
+                throw JSONException();
+
+            string_value = scratch;
+        }
+
+        token = JSONToken_String;
+    }
+
+    // Is it a boolean?
+    else if ((data_end - data >= 4 && strncasecmp(data, "true", 4) == 0) || (data_end - data >= 5 && strncasecmp(data, "false", 5) == 0))
+    {
+        bool_value = strncasecmp(data, "true", 4) == 0;
+        data += bool_value ? 4 : 5;
+        token = JSONToken_Bool;
+    }
+
+    // Is it a null?
+    else if (data_end - data >= 4 && strncasecmp(data, "null", 4) == 0)
+    {
+        data += 4;
+        token = JSONToken_Null;
+    }
+
+    // Is it a number?
+    else if (*data == '-' || (*data >= '0' && *data <= '9'))
+    {
+        number_value = JSON::ParseNumber(&data, data_end);
+        token = JSONToken_Number;
+    }
+
+    // An object or array?
+    else if (*data == '{' || *data == '[')
+    {
+        containers.push_back(*data);
+        token = *(data++) == '{' ? JSONToken_StartObject : JSONToken_StartArray;
+    }
+
+    // Ran out of possibilites, it's bad!
+    else
+    {
+        throw JSONException();
+    }
+}
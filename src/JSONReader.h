@@ -0,0 +1,89 @@
+/*
+ * File JSONReader.h part of the SimpleJSON Library - http://mjpa.in/json
+ *
+ * Copyright (C) 2010 Mike Anchor
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef _JSONREADER_H_
+#define _JSONREADER_H_
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "JSON.h"
+
+enum JSONToken { JSONToken_None, JSONToken_StartObject, JSONToken_Key, JSONToken_EndObject, JSONToken_StartArray,
+                 JSONToken_EndArray, JSONToken_String, JSONToken_Number, JSONToken_Bool, JSONToken_Null,
+                 JSONToken_End, JSONToken_Error };
+
+// Reads a document one token at a time, in document order, without building
+// any JSONValues. Call Next() to move to each token, then TokenType() and the
+// Get methods to read it. Strings refer into the text where they can, so the
+// text must outlive the reader, and are only valid until the next call.
+class JSONReader
+{
+    public:
+        JSONReader(const char *data);
+        JSONReader(const char *data, size_t length);
+
+        bool Next();
+        bool SkipValue();
+
+        JSONToken TokenType() const { return token; }
+        bool HasError() const { return token == JSONToken_Error; }
+        std::size_t Depth() const { return containers.size(); }
+
+        std::string_view GetString() const { return string_value; }
+        bool GetBool() const { return bool_value; }
+        bool IsInteger() const { return number_value.IsInteger(); }
+        double GetNumber() const { return number_value.AsNumber(); }
+        std::int64_t GetInt64() const { return number_value.AsInt64(); }
+        std::uint64_t GetUInt64() const { return number_value.AsUInt64(); }
+
+    protected:
+        void ReadToken();
+        void SkipContainer();
+        void ReadKey();
+        void ReadValue();
+
+    private:
+        const char *data;
+        const char *data_end;
+
+        // Where the current token starts
+        const char *token_start;
+
+        JSONToken token;
+
+        // The open objects and arrays, as '{' or '['
+        std::vector<char> containers;
+
+        std::string_view string_value;
+        bool bool_value;
+        JSONValue number_value;
+
+        // Escaped strings are unescaped into here
+        std::string scratch;
+};
+
+#endif
@@ -0,0 +1,705 @@
+/*
+ * File JSONSimd.cpp part of the SimpleJSON Library - http://mjpa.in/json
+ *
+ * Copyright (C) 2010 Mike Anchor
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+#include "JSONSimd.h"
+
+// Vector versions are built for GCC / Clang on x86, anything else gets
+// the scalar versions only
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SIMPLEJSON_SIMD_X86
+#include <immintrin.h>
+
+// The vector versions read whole aligned blocks. Those never cross a page
+// boundary, but they do read a few bytes either side of the text.
+#define SIMPLEJSON_SIMD_FUNCTION(target_name) \
+    __attribute__((target(target_name), no_sanitize_address))
+#endif
+
+// A bit for each of 64 characters, set where the character is of that kind
+struct BlockMasks
+{
+    std::uint64_t quote;
+    std::uint64_t backslash;
+    std::uint64_t op;
+    std::uint64_t whitespace;
+};
+
+// The implementations of each routine for one SIMD level
+struct SimdFunctions
+{
+    JSONSimdLevel level;
+    const char *(*skip_whitespace)(const char *ptr, const char *end);
+    const char *(*find_escape)(const char *ptr, const char *end);
+    std::size_t (*structural_index)(const char *data, std::size_t length, JSONStructuralState &state,
+                                    std::uint32_t *index);
+};
+
+/**
+ * Checks for the whitespace characters defined by the JSON spec
+ *
+ * @param char chr The character to check
+ *
+ * @return bool Returns true for space, tab, \r or \n
+ */
+static inline bool is_whitespace(char chr)
+{
+    return chr == ' ' || chr == '\t' || chr == '\r' || chr == '\n';
+}
+
+/**
+ * Skips whitespace one character at a time
+ *
+ * @param char* ptr The start of the text to skip the whitespace of
+ * @param char* end The end of the text
+ *
+ * @return char* Returns the first character that isn't whitespace, or end
+ */
+static const char *skip_whitespace_scalar(const char *ptr, const char *end)
+{
+    while (ptr != end && is_whitespace(*ptr))
+        ptr++;
+
+    return ptr;
+}
+
+/**
+ * Finds the first character that needs escaping one character at a time
+ *
+ * @param char* ptr The start of the text to search
+ * @param char* end The end of the text
+ *
+ * @return char* Returns the first quote, backslash or control character, or end
+ */
+static const char *find_escape_scalar(const char *ptr, const char *end)
+{
+    while (ptr != end && *ptr != '"' && *ptr != '\\' && static_cast<unsigned char>(*ptr) >= 0x20)
+        ptr++;
+
+    return ptr;
+}
+
+/**
+ * Counts the trailing zero bits of a non zero number
+ *
+ * @param uint64_t value The number to count the zeros of
+ *
+ * @return int Returns the number of trailing zeros
+ */
+static inline int trailing_zeros(std::uint64_t value)
+{
+#ifdef __GNUC__
+    return __builtin_ctzll(value);
+#else
+    int zeros = 0;
+    while ((value & 1) == 0)
+    {
+        value >>= 1;
+        zeros++;
+    }
+    return zeros;
+#endif
+}
+
+/**
+ * Finds 64 characters of a text, padding them out with whitespace past its end
+ *
+ * @param char* data The text
+ * @param size_t offset The offset of the characters
+ * @param size_t length The length of the text
+ * @param char* tail Somewhere for 64 characters to go
+ *
+ * @return char* Returns the 64 characters
+ */
+static inline const char *whole_block(const char *data, std::size_t offset, std::size_t length, char *tail)
+{
+    if (length - offset >= 64)
+        return data + offset;
+
+    memset(tail, ' ', 64);
+    memcpy(tail, data + offset, length - offset);
+    return tail;
+}
+
+/**
+ * Adds the structural characters among 64 characters to an index
+ *
+ * @param BlockMasks masks Where each kind of character is
+ * @param size_t offset The offset of the characters in the text
+ * @param JSONStructuralState state Carried over from the characters before
+ * @param uint32_t* out Receives the offsets of the structural characters
+ *
+ * @return uint32_t* Returns the end of the offsets written
+ */
+static inline std::uint32_t *add_structurals(const BlockMasks &masks, std::size_t offset, JSONStructuralState &state,
+                                             std::uint32_t *out)
+{
+    // A backslash escapes the next character unless it's escaped itself.
+    // Backslashes are rare, so they're just taken in turn.
+    std::uint64_t escaped = state.escaped;
+    std::uint64_t backslashes = masks.backslash & ~escaped;
+    state.escaped = 0;
+    while (backslashes != 0)
+    {
+        std::uint64_t bit = backslashes & (~backslashes + 1);
+        if (bit == 1ull << 63)
+            state.escaped = 1;
+        escaped |= bit << 1;
+        backslashes &= ~(bit | (bit << 1));
+    }
+
+    // Each unescaped quote flips in and out of a string, which an XOR of
+    // all the bits below each bit gives. The opening quote is inside.
+    std::uint64_t quotes = masks.quote & ~escaped;
+    std::uint64_t in_string = quotes;
+    for (int shift = 1; shift < 64; shift *= 2)
+        in_string ^= in_string << shift;
+    in_string ^= state.in_string;
+    state.in_string = 0 - (in_string >> 63);
+
+    // Anything else outside of a string is part of a number or literal,
+    // which starts where the character before isn't
+    std::uint64_t scalar = ~(masks.op | masks.whitespace | quotes | in_string);
+    std::uint64_t scalar_starts = scalar & ~((scalar << 1) | state.scalar);
+    state.scalar = scalar >> 63;
+
+    std::uint64_t structural = (masks.op & ~in_string) | (quotes & in_string) | scalar_starts;
+    while (structural != 0)
+    {
+        *(out++) = static_cast<std::uint32_t>(offset + trailing_zeros(structural));
+        structural &= structural - 1;
+    }
+
+    return out;
+}
+
+/**
+ * Sorts 64 characters into quotes, backslashes, { } [ ] : , and whitespace
+ * one character at a time
+ *
+ * @param char* block The 64 characters
+ * @param BlockMasks masks Set to where each kind of character is
+ */
+static inline void classify_scalar(const char *block, BlockMasks &masks)
+{
+    masks = BlockMasks();
+    for (int i = 0; i < 64; i++)
+    {
+        std::uint64_t bit = 1ull << i;
+        switch (block[i])
+        {
+            case '"': masks.quote |= bit; break;
+            case '\\': masks.backslash |= bit; break;
+            case '{': case '}': case '[': case ']': case ':': case ',': masks.op |= bit; break;
+            case ' ': case '\t': case '\r': case '\n': masks.whitespace |= bit; break;
+        }
+    }
+}
+
+/**
+ * Finds the structural characters of a part of a JSON text one character at a time
+ *
+ * @param char* data The text
+ * @param size_t length The length of the text, a multiple of 64 unless it's the last part
+ * @param JSONStructuralState state Carried over from the part before, if any
+ * @param uint32_t* index Receives the offsets of the structural characters
+ *
+ * @return size_t Returns the number of structural characters found
+ */
+static std::size_t structural_index_scalar(const char *data, std::size_t length, JSONStructuralState &state,
+                                           std::uint32_t *index)
+{
+    std::uint32_t *out = index;
+    char tail[64];
+
+    for (std::size_t offset = 0; offset < length; offset += 64)
+    {
+        BlockMasks masks;
+        classify_scalar(whole_block(data, offset, length, tail), masks);
+        out = add_structurals(masks, offset, state, out);
+    }
+
+    return out - index;
+}
+
+static const SimdFunctions scalar_functions = {
+    JSONSimd_Scalar, skip_whitespace_scalar, find_escape_scalar, structural_index_scalar
+};
+
+#ifdef SIMPLEJSON_SIMD_X86
+
+/**
+ * Skips whitespace 16 characters at a time
+ *
+ * @param char* ptr The start of the text to skip the whitespace of, before end
+ * @param char* end The end of the text
+ *
+ * @return char* Returns the first character that isn't whitespace, or end
+ */
+SIMPLEJSON_SIMD_FUNCTION("sse2")
+static const char *skip_whitespace_sse2(const char *ptr, const char *end)
+{
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i cr = _mm_set1_epi8('\r');
+    const __m128i lf = _mm_set1_epi8('\n');
+
+    // Start from the aligned block holding ptr and ignore the bytes before it
+    std::uintptr_t offset = reinterpret_cast<std::uintptr_t>(ptr) & 15;
+    const char *block = ptr - offset;
+    unsigned int ignore = 0xFFFFu >> (16 - offset);
+
+    while (block < end)
+    {
+        __m128i chunk = _mm_load_si128(reinterpret_cast<const __m128i *>(block));
+        __m128i whitespace = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, space), _mm_cmpeq_epi8(chunk, tab)),
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, cr), _mm_cmpeq_epi8(chunk, lf)));
+
+        unsigned int other = ~(static_cast<unsigned int>(_mm_movemask_epi8(whitespace)) | ignore) & 0xFFFFu;
+        if (other != 0)
+        {
+            // The last block can run past the end of the text
+            const char *first = block + __builtin_ctz(other);
+            return first < end ? first : end;
+        }
+
+        block += 16;
+        ignore = 0;
+    }
+    return end;
+}
+
+/**
+ * Skips whitespace 32 characters at a time
+ *
+ * @param char* ptr The start of the text to skip the whitespace of, before end
+ * @param char* end The end of the text
+ *
+ * @return char* Returns the first character that isn't whitespace, or end
+ */
+SIMPLEJSON_SIMD_FUNCTION("avx2")
+static const char *skip_whitespace_avx2(const char *ptr, const char *end)
+{
+    const __m256i space = _mm256_set1_epi8(' ');
+    const __m256i tab = _mm256_set1_epi8('\t');
+    const __m256i cr = _mm256_set1_epi8('\r');
+    const __m256i lf = _mm256_set1_epi8('\n');
+
+    // Start from the aligned block holding ptr and ignore the bytes before it
+    std::uintptr_t offset = reinterpret_cast<std::uintptr_t>(ptr) & 31;
+    const char *block = ptr - offset;
+    std::uint32_t ignore = offset ? 0xFFFFFFFFu >> (32 - offset) : 0;
+
+    while (block < end)
+    {
+        __m256i chunk = _mm256_load_si256(reinterpret_cast<const __m256i *>(block));
+        __m256i whitespace = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(chunk, space), _mm256_cmpeq_epi8(chunk, tab)),
+            _mm256_or_si256(_mm256_cmpeq_epi8(chunk, cr), _mm256_cmpeq_epi8(chunk, lf)));
+
+        std::uint32_t other = ~(static_cast<std::uint32_t>(_mm256_movemask_epi8(whitespace)) | ignore);
+        if (other != 0)
+        {
+            // The last block can run past the end of the text
+            const char *first = block + __builtin_ctz(other);
+            return first < end ? first : end;
+        }
+
+        block += 32;
+        ignore = 0;
+    }
+    return end;
+}
+
+/**
+ * Finds the first character that needs escaping 16 characters at a time
+ *
+ * @param char* ptr The start of the text to search, before end
+ * @param char* end The end of the text
+ *
+ * @return char* Returns the first quote, backslash or control character, or end
+ */
+SIMPLEJSON_SIMD_FUNCTION("sse2")
+static const char *find_escape_sse2(const char *ptr, const char *end)
+{
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i control_max = _mm_set1_epi8(0x1F);
+
+    // Start from the aligned block holding ptr and ignore the bytes before it
+    std::uintptr_t offset = reinterpret_cast<std::uintptr_t>(ptr) & 15;
+    const char *block = ptr - offset;
+    unsigned int ignore = 0xFFFFu >> (16 - offset);
+
+    while (block < end)
+    {
+        __m128i chunk = _mm_load_si128(reinterpret_cast<const __m128i *>(block));
+        __m128i special = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)),
+            _mm_cmpeq_epi8(_mm_min_epu8(chunk, control_max), chunk));
+
+        unsigned int found = static_cast<unsigned int>(_mm_movemask_epi8(special)) & ~ignore;
+        if (found != 0)
+        {
+            // The last block can run past the end of the text
+            const char *first = block + __builtin_ctz(found);
+            return first < end ? first : end;
+        }
+
+        block += 16;
+        ignore = 0;
+    }
+
+    return end;
+}
+
+/**
+ * Finds the first character that needs escaping 32 characters at a time
+ *
+ * @param char* ptr The start of the text to search, before end
+ * @param char* end The end of the text
+ *
+ * @return char* Returns the first quote, backslash or control character, or end
+ */
+SIMPLEJSON_SIMD_FUNCTION("avx2")
+static const char *find_escape_avx2(const char *ptr, const char *end)
+{
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    const __m256i control_max = _mm256_set1_epi8(0x1F);
+
+    // Start from the aligned block holding ptr and ignore the bytes before it
+    std::uintptr_t offset = reinterpret_cast<std::uintptr_t>(ptr) & 31;
+    const char *block = ptr - offset;
+    std::uint32_t ignore = offset ? 0xFFFFFFFFu >> (32 - offset) : 0;
+
+    while (block < end)
+    {
+        __m256i chunk = _mm256_load_si256(reinterpret_cast<const __m256i *>(block));
+        __m256i special = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(chunk, quote), _mm256_cmpeq_epi8(chunk, backslash)),
+            _mm256_cmpeq_epi8(_mm256_min_epu8(chunk, control_max), chunk));
+
+        std::uint32_t found = static_cast<std::uint32_t>(_mm256_movemask_epi8(special)) & ~ignore;
+        if (found != 0)
+        {
+            // The last block can run past the end of the text
+            const char *first = block + __builtin_ctz(found);
+            return first < end ? first : end;
+        }
+
+        block += 32;
+        ignore = 0;
+    }
+
+    return end;
+}
+
+/**
+ * Sorts 64 characters into quotes, backslashes, { } [ ] : , and whitespace
+ * 16 characters at a time
+ *
+ * @param char* block The 64 characters
+ * @param BlockMasks masks Set to where each kind of character is
+ */
+SIMPLEJSON_SIMD_FUNCTION("sse2")
+static inline void classify_sse2(const char *block, BlockMasks &masks)
+{
+    // [ and ] are { and } with the 0x20 bit clear
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i case_bit = _mm_set1_epi8(0x20);
+    const __m128i open_brace = _mm_set1_epi8('{');
+    const __m128i close_brace = _mm_set1_epi8('}');
+    const __m128i colon = _mm_set1_epi8(':');
+    const __m128i comma = _mm_set1_epi8(',');
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i cr = _mm_set1_epi8('\r');
+    const __m128i lf = _mm_set1_epi8('\n');
+
+    masks = BlockMasks();
+    for (int i = 0; i < 4; i++)
+    {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(block + i * 16));
+        __m128i folded = _mm_or_si128(chunk, case_bit);
+        __m128i op = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(folded, open_brace), _mm_cmpeq_epi8(folded, close_brace)),
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, colon), _mm_cmpeq_epi8(chunk, comma)));
+        __m128i whitespace = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, space), _mm_cmpeq_epi8(chunk, tab)),
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, cr), _mm_cmpeq_epi8(chunk, lf)));
+
+        int shift = i * 16;
+        masks.quote |= static_cast<std::uint64_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, quote))) << shift;
+        masks.backslash |= static_cast<std::uint64_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, backslash))) << shift;
+        masks.op |= static_cast<std::uint64_t>(_mm_movemask_epi8(op)) << shift;
+        masks.whitespace |= static_cast<std::uint64_t>(_mm_movemask_epi8(whitespace)) << shift;
+    }
+}
+
+/**
+ * Sorts 64 characters into quotes, backslashes, { } [ ] : , and whitespace
+ * 32 characters at a time
+ *
+ * @param char* block The 64 characters
+ * @param BlockMasks masks Set to where each kind of character is
+ */
+SIMPLEJSON_SIMD_FUNCTION("avx2")
+static inline void classify_avx2(const char *block, BlockMasks &masks)
+{
+    // [ and ] are { and } with the 0x20 bit clear
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    const __m256i case_bit = _mm256_set1_epi8(0x20);
+    const __m256i open_brace = _mm256_set1_epi8('{');
+    const __m256i close_brace = _mm256_set1_epi8('}');
+    const __m256i colon = _mm256_set1_epi8(':');
+    const __m256i comma = _mm256_set1_epi8(',');
+    const __m256i space = _mm256_set1_epi8(' ');
+    const __m256i tab = _mm256_set1_epi8('\t');
+    const __m256i cr = _mm256_set1_epi8('\r');
+    const __m256i lf = _mm256_set1_epi8('\n');
+
+    masks = BlockMasks();
+    for (int i = 0; i < 2; i++)
+    {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(block + i * 32));
+        __m256i folded = _mm256_or_si256(chunk, case_bit);
+        __m256i op = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(folded, open_brace), _mm256_cmpeq_epi8(folded, close_brace)),
+            _mm256_or_si256(_mm256_cmpeq_epi8(chunk, colon), _mm256_cmpeq_epi8(chunk, comma)));
+        __m256i whitespace = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(chunk, space), _mm256_cmpeq_epi8(chunk, tab)),
+            _mm256_or_si256(_mm256_cmpeq_epi8(chunk, cr), _mm256_cmpeq_epi8(chunk, lf)));
+
+        int shift = i * 32;
+        masks.quote |= static_cast<std::uint64_t>(static_cast<std::uint32_t>(
+            _mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, quote)))) << shift;
+        masks.backslash |= static_cast<std::uint64_t>(static_cast<std::uint32_t>(
+            _mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, backslash)))) << shift;
+        masks.op |= static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm256_movemask_epi8(op))) << shift;
+        masks.whitespace |= static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm256_movemask_epi8(whitespace))) << shift;
+    }
+}
+
+/**
+ * Finds the structural characters of a part of a JSON text 16 characters at a time
+ *
+ * @param char* data The text
+ * @param size_t length The length of the text, a multiple of 64 unless it's the last part
+ * @param JSONStructuralState state Carried over from the part before, if any
+ * @param uint32_t* index Receives the offsets of the structural characters
+ *
+ * @return size_t Returns the number of structural characters found
+ */
+SIMPLEJSON_SIMD_FUNCTION("sse2")
+static std::size_t structural_index_sse2(const char *data, std::size_t length, JSONStructuralState &state,
+                                         std::uint32_t *index)
+{
+    std::uint32_t *out = index;
+    char tail[64];
+
+    for (std::size_t offset = 0; offset < length; offset += 64)
+    {
+        BlockMasks masks;
+        classify_sse2(whole_block(data, offset, length, tail), masks);
+        out = add_structurals(masks, offset, state, out);
+    }
+
+    return out - index;
+}
+
+/**
+ * Finds the structural characters of a part of a JSON text 32 characters at a time
+ *
+ * @param char* data The text
+ * @param size_t length The length of the text, a multiple of 64 unless it's the last part
+ * @param JSONStructuralState state Carried over from the part before, if any
+ * @param uint32_t* index Receives the offsets of the structural characters
+ *
+ * @return size_t Returns the number of structural characters found
+ */
+SIMPLEJSON_SIMD_FUNCTION("avx2")
+static std::size_t structural_index_avx2(const char *data, std::size_t length, JSONStructuralState &state,
+                                         std::uint32_t *index)
+{
+    std::uint32_t *out = index;
+    char tail[64];
+
+    for (std::size_t offset = 0; offset < length; offset += 64)
+    {
+        BlockMasks masks;
+        classify_avx2(whole_block(data, offset, length, tail), masks);
+        out = add_structurals(masks, offset, state, out);
+    }
+
+    return out - index;
+}
+
+static const SimdFunctions sse2_functions = {
+    JSONSimd_SSE2, skip_whitespace_sse2, find_escape_sse2, structural_index_sse2
+};
+static const SimdFunctions avx2_functions = {
+    JSONSimd_AVX2, skip_whitespace_avx2, find_escape_avx2, structural_index_avx2
+};
+
+#endif
+
+// The implementations in use, picked on first use
+static std::atomic<const SimdFunctions *> active_functions(0);
+
+/**
+ * Picks the best implementations the CPU supports, up to the given level
+ *
+ * @param JSONSimdLevel max_level The highest level to consider
+ *
+ * @return SimdFunctions* Returns the implementations to use
+ */
+static const SimdFunctions *best_functions(JSONSimdLevel max_level)
+{
+#ifdef SIMPLEJSON_SIMD_X86
+    __builtin_cpu_init();
+    if (max_level >= JSONSimd_AVX2 && __builtin_cpu_supports("avx2"))
+        return &avx2_functions;
+    if (max_level >= JSONSimd_SSE2 && __builtin_cpu_supports("sse2"))
+        return &sse2_functions;
+#else
+    (void)max_level;
+#endif
+    return &scalar_functions;
+}
+
+/**
+ * Retrieves the implementations in use, picking them on the first call
+ *
+ * @return SimdFunctions Returns the implementations to use
+ */
+static inline const SimdFunctions &functions()
+{
+    const SimdFunctions *active = active_functions.load(std::memory_order_relaxed);
+    if (active == 0)
+    {
+        active = best_functions(JSONSimd_AVX2);
+        active_functions.store(active, std::memory_order_relaxed);
+    }
+
+    return *active;
+}
+
+/**
+ * Retrieves the SIMD level in use
+ *
+ * @return JSONSimdLevel Returns the level in use
+ */
+JSONSimdLevel simplejson_simd_level()
+{
+    return functions().level;
+}
+
+/**
+ * Forces the SIMD level to use, or the best supported one below it
+ *
+ * @param JSONSimdLevel level The highest level to use
+ */
+void simplejson_set_simd_level(JSONSimdLevel level)
+{
+    active_functions.store(best_functions(level), std::memory_order_relaxed);
+}
+
+/**
+ * Skips over any whitespace characters (space, tab, \r or \n)
+ *
+ * @param char* ptr The start of the text to skip the whitespace of
+ * @param char* end The end of the text
+ *
+ * @return char* Returns the first character that isn't whitespace, or end
+ */
+const char *simplejson_skip_whitespace(const char *ptr, const char *end)
+{
+    if (ptr == end)
+        return end;
+
+    return functions().skip_whitespace(ptr, end);
+}
+
+/**
+ * Finds the first character that needs escaping in a JSON string
+ *
+ * @param char* ptr The start of the text to search
+ * @param char* end The end of the text
+ *
+ * @return char* Returns the first quote, backslash or control character, or end
+ */
+const char *simplejson_find_escape(const char *ptr, const char *end)
+{
+    if (ptr == end)
+        return end;
+
+    return functions().find_escape(ptr, end);
+}
+
+/**
+ * Finds the structural characters of a part of a JSON text
+ *
+ * @param char* data The text
+ * @param size_t length The length of the text, a multiple of 64 unless it's the last part
+ * @param JSONStructuralState state Carried over from the part before, if any
+ * @param uint32_t* index Receives the offsets of the structural characters
+ *
+ * @return size_t Returns the number of structural characters found
+ */
+std::size_t simplejson_structural_index(const char *data, std::size_t length, JSONStructuralState &state,
+                                        std::uint32_t *index)
+{
+    return functions().structural_index(data, length, state, index);
+}
+
+/**
+ * Finds the structural characters of the next batch of the text that has any
+ *
+ * @return bool Returns false if the end of the text has been reached
+ */
+bool JSONStructuralIndex::Fill()
+{
+    while (scanned < length)
+    {
+        std::size_t size = length - scanned < batch_size ? length - scanned : batch_size;
+        batch = data + scanned;
+        count = simplejson_structural_index(batch, size, state, tokens);
+        position = 0;
+        scanned += size;
+
+        if (count != 0)
+            return true;
+    }
+
+    count = 0;
+    position = 0;
+    return false;
+}
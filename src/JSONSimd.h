@@ -0,0 +1,115 @@
+/*
+ * File JSONSimd.h part of the SimpleJSON Library - http://mjpa.in/json
+ *
+ * Copyright (C) 2010 Mike Anchor
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef _JSONSIMD_H_
+#define _JSONSIMD_H_
+
+#include <cstddef>
+#include <cstdint>
+
+// Byte scanning routines used by the parser. The best implementation the
+// CPU supports is picked at runtime, with a portable scalar fallback.
+enum JSONSimdLevel { JSONSimd_Scalar, JSONSimd_SSE2, JSONSimd_AVX2 };
+
+// The level in use, and a way to force a lower one (e.g. for benchmarks).
+// Asking for a level the CPU doesn't support gives the best one it does.
+JSONSimdLevel simplejson_simd_level();
+void simplejson_set_simd_level(JSONSimdLevel level);
+
+// Returns a pointer to the first character in [ptr, end) that isn't JSON
+// whitespace, or end if there isn't one
+const char *simplejson_skip_whitespace(const char *ptr, const char *end);
+
+// Returns a pointer to the first quote, backslash or control character in
+// [ptr, end), or end if there isn't one
+const char *simplejson_find_escape(const char *ptr, const char *end);
+
+// What simplejson_structural_index() needs to know about the text before
+// the part it's given: whether it ends in an escape, in a string, or partway
+// through a number or literal
+struct JSONStructuralState
+{
+    std::uint64_t escaped = 0;
+    std::uint64_t in_string = 0;
+    std::uint64_t scalar = 0;
+};
+
+// Finds the structural characters in 'length' characters of JSON text: the
+// { } [ ] : and , outside of strings, the quote opening each string and the
+// first character of each number or literal. Their offsets from 'data' are
+// written to 'index', which needs room for 'length' entries, and the count
+// is returned. Long text (the offsets are 32 bit) can be given in parts that
+// are a multiple of 64 characters long, bar the last, with the same 'state'.
+std::size_t simplejson_structural_index(const char *data, std::size_t length, JSONStructuralState &state,
+                                        std::uint32_t *index);
+
+// Walks the structural characters of a text, finding them a batch at a
+// time so the index stays small and in the cache
+class JSONStructuralIndex
+{
+    public:
+        // The most offsets a batch can need room for
+        static const std::size_t batch_size = 4096;
+
+        // 'tokens' is where each batch is indexed, with room for batch_size
+        // offsets, so that it can be reused from one text to the next
+        JSONStructuralIndex(const char *data, std::size_t length, std::uint32_t *tokens)
+            : data(data), length(length), scanned(0), batch(data), tokens(tokens), count(0), position(0) {}
+
+        // The current structural character, or End() once there are no more
+        const char *Current()
+        {
+            if (position >= count && !Fill())
+                return data + length;
+
+            return batch + tokens[position];
+        }
+
+        // The character Current() points to, or 0 at the end
+        char Character()
+        {
+            if (position >= count && !Fill())
+                return 0;
+
+            return batch[tokens[position]];
+        }
+
+        const char *End() const { return data + length; }
+
+        void Advance() { position++; }
+
+    private:
+        bool Fill();
+
+        const char *data;
+        std::size_t length;
+        std::size_t scanned;
+        const char *batch;
+        JSONStructuralState state;
+        std::uint32_t *tokens;
+        std::size_t count;
+        std::size_t position;
+};
+
+#endif
@@ -30,8 +30,52 @@
 #include <sstream>
 #include <iostream>
 #include <math.h>
+#include <new>
+#include <utility>
+#include <charconv>
+#include <algorithm>
+#include <memory>
+#include <ostream>
+#include <cerrno>
+#include <climits>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
 
 #include "JSONValue.h"
+#include "JSONNumber.h"
+#include "JSONSimd.h"
+
+/**
+ * Makes the key for an object member, interning it when the parse has a pool
+ *
+ * @param std::string_view text The unescaped key
+ * @param JSONParseContext context The state for this parse
+ *
+ * @return JSONObject::key_type Returns the key to store
+ */
+static JSONObject::key_type ObjectKey(std::string_view text, JSONParseContext &context)
+{
+#ifdef SIMPLEJSON_SORTED_OBJECTS
+    (void)context;
+    return std::string(text);
+#else
+    if (context.keys == 0)
+        return JSONKey(text);
+
+    // Documents tend to repeat the same keys, the last few are kept so
+    // those don't need to take the pool's lock
+    std::size_t hash = std::hash<std::string_view>()(text);
+    JSONKey &cached = context.key_cache[hash % JSONParseContext::key_cache_size];
+    if (cached.IsInterned() && cached.Hash() == hash && cached.view() == text)
+        return cached;
+
+    cached = context.keys->Intern(text, hash);
+    return cached;
+#endif
+}
 
 /**
  * Parses a JSON encoded value to a JSONValue object
@@ -39,23 +83,54 @@
  * @access protected
  *
  * @param char** data Pointer to a char* that contains the data
+ * @param char* end The end of the text, after *data
+ * @param JSONParseContext context The state for this parse
  *
- * @return JSONValue* Returns a pointer to a JSONValue object on success, NULL on error
+ * @return JSONValue Returns the parsed value or throw JSONException on error
  */
-JSONValue JSONValue::Parse(const char **data)
+JSONValue JSONValue::Parse(const char **data, const char *end, JSONParseContext &context)
 {
     // Is it a string?
     if (**data == '"')
     {
-        std::string str;
-        if (!JSON::ExtractString(&(++(*data)), str))
+        (*data)++;
+
+        // Strings without escapes can refer straight into the caller's text
+        std::string_view view;
+        if (context.borrow_strings && JSON::ExtractStringView(data, end, view))
+            return StringRef(view.data(), view.size());
+
+        // Escaped strings are unescaped over themselves when the text is ours
+        if (context.in_situ)
+        {
+            if (!JSON::ExtractStringInSitu(data, end, view))
+                throw JSONException();
+
+            return StringRef(view.data(), view.size());
+        }
+
+        if (context.arena == 0)
+        {
+            std::string str;
+            if (!JSON::ExtractString(data, end, str))
+                throw JSONException();
+
+            str.shrink_to_fit(); // Remove unused capacity
+            return JSONValue(std::move(str));
+        }
+
+        // Arena strings are unescaped into the scratch buffer then copied over
+        if (!JSON::ExtractString(data, end, context.scratch))
             throw JSONException();
 
-        return JSONValue(str);
+        std::size_t size = context.scratch.size();
+        char *str = static_cast<char *>(context.arena->Allocate(size, 1));
+        memcpy(str, context.scratch.data(), size);
+        return StringRef(str, size);
     }
 
     // Is it a boolean?
-    else if ((simplejson_strnlen(*data, 4) && strncasecmp(*data, "true", 4) == 0) || (simplejson_strnlen(*data, 5) && strncasecmp(*data, "false", 5) == 0))
+    else if ((end - *data >= 4 && strncasecmp(*data, "true", 4) == 0) || (end - *data >= 5 && strncasecmp(*data, "false", 5) == 0))
     {
         bool value = strncasecmp(*data, "true", 4) == 0;
         (*data) += value ? 4 : 5;
@@ -63,7 +138,7 @@ JSONValue JSONValue::Parse(const char **data)
     }
 
     // Is it a null?
-    else if (simplejson_strnlen(*data, 4) && strncasecmp(*data, "null", 4) == 0)
+    else if (end - *data >= 4 && strncasecmp(*data, "null", 4) == 0)
     {
         (*data) += 4;
         return JSONValue();
@@ -72,94 +147,56 @@ JSONValue JSONValue::Parse(const char **data)
     // Is it a number?
     else if (**data == '-' || (**data >= '0' && **data <= '9'))
     {
-        // Negative?
-        bool neg = **data == '-';
-        if (neg) (*data)++;
-
-        double number = 0.0;
-
-        // Parse the whole part of the number - only if it wasn't 0
-        if (**data == '0')
-            (*data)++;
-        else if (**data >= '1' && **data <= '9')
-            number = JSON::ParseInt(data);
-        else
-            throw JSONException();
-
-        // Could be a decimal now...
-        if (**data == '.')
-        {
-            (*data)++;
-
-            // Not get any digits?
-            if (!(**data >= '0' && **data <= '9'))
-                throw JSONException();
-
-            // Find the decimal and sort the decimal place out
-            // Use ParseDecimal as ParseInt won't work with decimals less than 0.1
-            // thanks to Javier Abadia for the report & fix
-            double decimal = JSON::ParseDecimal(data);
-
-            // Save the number
-            number += decimal;
-        }
-
-        // Could be an exponent now...
-        if (**data == 'E' || **data == 'e')
+        // Lazy numbers keep referring to their text until they're read
+        if (context.lazy_numbers)
         {
-            (*data)++;
-
-            // Check signage of expo
-            bool neg_expo = false;
-            if (**data == '-' || **data == '+')
-            {
-                neg_expo = **data == '-';
-                (*data)++;
-            }
-
-            // Not get any digits?
-            if (!(**data >= '0' && **data <= '9'))
+            const char *start = *data;
+            if (!JSON::SkipNumber(data, end))
                 throw JSONException();
 
-            // Sort the expo out
-            double expo = JSON::ParseInt(data);
-            for (double i = 0.0; i < expo; i++)
-                number = neg_expo ? (number / 10.0) : (number * 10.0);
+            return NumberRef(start, *data - start);
         }
 
-        // Was it neg?
-        if (neg) number *= -1;
-
-        return JSONValue(number);
+        return JSON::ParseNumber(data, end);
     }
 
     // An object?
     else if (**data == '{')
     {
-        JSONObject object;
+        JSONObject object = JSONObject(JSONObject::allocator_type(context.arena));
 
         (*data)++;
 
-        while (**data != 0)
+        while (*data != end)
         {
             // Whitespace at the start?
-            if (!JSON::SkipWhitespace(data))
+            if (!JSON::SkipWhitespace(data, end))
                 throw JSONException();
 
             // Special case - empty object
             if (object.size() == 0 && **data == '}')
             {
                 (*data)++;
-                return JSONValue(object);
+                return JSONValue(std::move(object));
             }
 
             // We want a string now...
-            std::string name;
-            if (!JSON::ExtractString(&(++(*data)), name))
+            std::string_view name_text;
+            if (*((*data)++) != '"')
                 throw JSONException();
 
+            if (!context.borrow_strings || !JSON::ExtractStringView(data, end, name_text))
+            {
+                if (!JSON::ExtractString(data, end, context.scratch))
+                    throw JSONException();
+
+                name_text = context.scratch;
+            }
+
+            JSONObject::key_type name = ObjectKey(name_text, context);
+
             // More whitespace?
-            if (!JSON::SkipWhitespace(data))
+            if (!JSON::SkipWhitespace(data, end))
                 throw JSONException();
 
             // Need a : now
@@ -167,24 +204,21 @@ JSONValue JSONValue::Parse(const char **data)
                 throw JSONException();
 
             // More whitespace?
-            if (!JSON::SkipWhitespace(data))
+            if (!JSON::SkipWhitespace(data, end))
                 throw JSONException();
 
-            // The value is here
-            JSONValue value = Parse(data);
-
-            // Add the name:value
-            object[name] = value;
+            // The value is here, add the name:value
+            object[std::move(name)] = Parse(data, end, context);
 
             // More whitespace?
-            if (!JSON::SkipWhitespace(data))
+            if (!JSON::SkipWhitespace(data, end))
                 throw JSONException();
 
             // End of object?
             if (**data == '}')
             {
                 (*data)++;
-                return JSONValue(object);
+                return JSONValue(std::move(object));
             }
 
             // Want a , now
@@ -201,38 +235,35 @@ JSONValue JSONValue::Parse(const char **data)
     // An array?
     else if (**data == '[')
     {
-        JSONArray array;
+        JSONArray array = JSONArray(JSONArray::allocator_type(context.arena));
 
         (*data)++;
 
-        while (**data != 0)
+        while (*data != end)
         {
             // Whitespace at the start?
-            if (!JSON::SkipWhitespace(data))
+            if (!JSON::SkipWhitespace(data, end))
                 throw JSONException();
 
             // Special case - empty array
             if (array.size() == 0 && **data == ']')
             {
                 (*data)++;
-                return JSONValue(array);
+                return JSONValue(std::move(array));
             }
 
-            // Get the value
-            JSONValue value = Parse(data);
-
-            // Add the value
-            array.push_back(value);
+            // Get the value and add it
+            array.push_back(Parse(data, end, context));
 
             // More whitespace?
-            if (!JSON::SkipWhitespace(data))
+            if (!JSON::SkipWhitespace(data, end))
                 throw JSONException();
 
             // End of array?
             if (**data == ']')
             {
                 (*data)++;
-                return JSONValue(array);
+                return JSONValue(std::move(array));
             }
 
             // Want a , now
@@ -253,6 +284,122 @@ JSONValue JSONValue::Parse(const char **data)
     }
 }
 
+/**
+ * Parses a JSON encoded value to a JSONValue object by walking its
+ * structural characters, so only strings, numbers and literals are read
+ * character by character
+ *
+ * @access protected
+ *
+ * @param JSONStructuralIndex index The structural characters, at the value's first
+ * @param JSONParseContext context The state for this parse
+ *
+ * @return JSONValue Returns the parsed value or throw JSONException on error
+ */
+JSONValue JSONValue::ParseIndexed(JSONStructuralIndex &index, JSONParseContext &context)
+{
+    const char *end = index.End();
+    const char *token = index.Current();
+    if (token == end)
+        throw JSONException();
+
+    index.Advance();
+
+    // An object?
+    if (*token == '{')
+    {
+        JSONObject object = JSONObject(JSONObject::allocator_type(context.arena));
+
+        // Special case - empty object
+        if (index.Character() == '}')
+        {
+            index.Advance();
+            return JSONValue(std::move(object));
+        }
+
+        while (true)
+        {
+            // We want a string now...
+            if (index.Character() != '"')
+                throw JSONException();
+
+            const char *data = index.Current() + 1;
+            index.Advance();
+
+            std::string_view name_text;
+            if (!context.borrow_strings || !JSON::ExtractStringView(&data, end, name_text))
+            {
+                if (!JSON::ExtractString(&data, end, context.scratch))
+                    throw JSONException();
+
+                name_text = context.scratch;
+            }
+
+            JSONObject::key_type name = ObjectKey(name_text, context);
+
+            // Need a : now, only whitespace can come between it and the string
+            if (index.Character() != ':')
+                throw JSONException();
+
+            index.Advance();
+
+            // The value is here, add the name:value
+            object[std::move(name)] = ParseIndexed(index, context);
+
+            // End of object?
+            char next = index.Character();
+            index.Advance();
+            if (next == '}')
+                return JSONValue(std::move(object));
+
+            // Want a , now
+            if (next != ',')
+                throw JSONException();
+        }
+    }
+
+    // An array?
+    else if (*token == '[')
+    {
+        JSONArray array = JSONArray(JSONArray::allocator_type(context.arena));
+
+        // Special case - empty array
+        if (index.Character() == ']')
+        {
+            index.Advance();
+            return JSONValue(std::move(array));
+        }
+
+        while (true)
+        {
+            // Get the value and add it
+            array.push_back(ParseIndexed(index, context));
+
+            // End of array?
+            char next = index.Character();
+            index.Advance();
+            if (next == ']')
+                return JSONValue(std::move(array));
+
+            // Want a , now
+            if (next != ',')
+                throw JSONException();
+        }
+    }
+
+    // Strings, numbers and literals are parsed as usual. A number or literal
+    // has to take up all the characters up to the next whitespace or structural
+    // character, so "truex" and "1.5.2" fail.
+    const char *data = token;
+    JSONValue value = (*token == '-' || (*token >= '0' && *token <= '9')) && !context.lazy_numbers ?
+        JSON::ParseNumber(&data, end) : Parse(&data, end, context);
+    if (*token != '"' && data != index.Current() &&
+        *data != ' ' && *data != '\t' && *data != '\r' && *data != '\n')
+        throw JSONException();
+
+    return value;
+}
+
 /**
  * Basic constructor for creating a JSON Value of type NULL
  *
@@ -273,7 +420,7 @@ JSONValue::JSONValue(/*NULL*/)
 JSONValue::JSONValue(const char *m_char_value)
 {
     type = JSONType_String;
-    string_value = std::string(m_char_value);
+    new (&string_value) std::string(m_char_value);
 }
 
 /**
@@ -286,7 +433,21 @@ JSONValue::JSONValue(const char *m_char_value)
 JSONValue::JSONValue(const std::string &m_string_value)
 {
     type = JSONType_String;
-    string_value = m_string_value;
+    new (&string_value) std::string(m_string_value);
+}
+
+/**
+ * Basic constructor for creating a JSON Value of type String
+ * Takes over the given string without copying it
+ *
+ * @access public
+ *
+ * @param std::string m_string_value The string to move into the value
+ */
+JSONValue::JSONValue(std::string &&m_string_value)
+{
+    type = JSONType_String;
+    new (&string_value) std::string(std::move(m_string_value));
 }
 
 /**
@@ -316,7 +477,7 @@ JSONValue::JSONValue(double m_number_value)
 }
 
 /**
- * Basic constructor for creating a JSON Value of type Number
+ * Basic constructor for creating a JSON Value of type Integer
  *
  * @access public
  *
@@ -324,8 +485,42 @@ JSONValue::JSONValue(double m_number_value)
  */
 JSONValue::JSONValue(int m_integer_value)
 {
-    type = JSONType_Number;
-    number_value = (double) m_integer_value;
+    type = JSONType_Integer;
+    integer_value = m_integer_value;
+}
+
+/**
+ * Basic constructor for creating a JSON Value of type Integer
+ *
+ * @access public
+ *
+ * @param int64_t m_integer_value The number to use as the value
+ */
+JSONValue::JSONValue(std::int64_t m_integer_value)
+{
+    type = JSONType_Integer;
+    integer_value = m_integer_value;
+}
+
+/**
+ * Basic constructor for creating a JSON Value of type Integer
+ *
+ * @access public
+ *
+ * @param uint64_t m_integer_value The number to use as the value
+ */
+JSONValue::JSONValue(std::uint64_t m_integer_value)
+{
+    type = JSONType_Integer;
+    if (m_integer_value > static_cast<std::uint64_t>(INT64_MAX))
+    {
+        integer_unsigned = true;
+        unsigned_value = m_integer_value;
+    }
+    else
+    {
+        integer_value = static_cast<std::int64_t>(m_integer_value);
+    }
 }
 
 /**
@@ -338,7 +533,21 @@ JSONValue::JSONValue(int m_integer_value)
 JSONValue::JSONValue(const JSONArray &m_array_value)
 {
     type = JSONType_Array;
-    array_value = m_array_value;
+    new (&array_value) JSONArray(m_array_value);
+}
+
+/**
+ * Basic constructor for creating a JSON Value of type Array
+ * Takes over the given array without copying its elements
+ *
+ * @access public
+ *
+ * @param JSONArray m_array_value The JSONArray to move into the value
+ */
+JSONValue::JSONValue(JSONArray &&m_array_value)
+{
+    type = JSONType_Array;
+    new (&array_value) JSONArray(std::move(m_array_value));
 }
 
 /**
@@ -351,7 +560,104 @@ JSONValue::JSONValue(const JSONArray &m_array_value)
 JSONValue::JSONValue(const JSONObject &m_object_value)
 {
     type = JSONType_Object;
-    object_value = m_object_value;
+    new (&object_value) JSONObject(m_object_value);
+}
+
+/**
+ * Basic constructor for creating a JSON Value of type Object
+ * Takes over the given object without copying its members
+ *
+ * @access public
+ *
+ * @param JSONObject m_object_value The JSONObject to move into the value
+ */
+JSONValue::JSONValue(JSONObject &&m_object_value)
+{
+    type = JSONType_Object;
+    new (&object_value) JSONObject(std::move(m_object_value));
+}
+
+/**
+ * Copy constructor, performs a deep copy of the source value
+ *
+ * @access public
+ *
+ * @param JSONValue m_source The JSONValue to copy
+ */
+JSONValue::JSONValue(const JSONValue &m_source)
+{
+    type = JSONType_Null;
+    CopyFrom(m_source);
+}
+
+/**
+ * Move constructor, takes over the payload of the source value
+ * The source is left as a NULL value
+ *
+ * @access public
+ *
+ * @param JSONValue m_source The JSONValue to move from
+ */
+JSONValue::JSONValue(JSONValue &&m_source) noexcept
+{
+    type = JSONType_Null;
+    MoveFrom(m_source);
+}
+
+/**
+ * The destructor for the JSON Value object
+ * Destroys whichever payload is currently held
+ *
+ * @access public
+ */
+JSONValue::~JSONValue()
+{
+    Clear();
+}
+
+/**
+ * Assignment operator, performs a deep copy of the source value
+ *
+ * @access public
+ *
+ * @param JSONValue m_source The JSONValue to copy
+ *
+ * @return JSONValue& Returns a reference to this value
+ */
+JSONValue &JSONValue::operator=(const JSONValue &m_source)
+{
+    if (this != &m_source)
+    {
+        // The source may live inside our own payload so copy it out first
+        JSONValue copy(m_source);
+        Clear();
+        MoveFrom(copy);
+    }
+
+    return *this;
+}
+
+/**
+ * Move assignment operator, takes over the payload of the source value
+ * The source is left as a NULL value
+ *
+ * @access public
+ *
+ * @param JSONValue m_source The JSONValue to move from
+ *
+ * @return JSONValue& Returns a reference to this value
+ */
+JSONValue &JSONValue::operator=(JSONValue &&m_source) noexcept
+{
+    if (this != &m_source)
+    {
+        // The source may live inside our own payload so move it out first
+        JSONValue moved(std::move(m_source));
+        Clear();
+        MoveFrom(moved);
+    }
+
+    return *this;
 }
 
 /**
@@ -391,7 +697,7 @@ bool JSONValue::IsBool() const
 }
 
 /**
- * Checks if the value is a Number
+ * Checks if the value is a Number, which includes Integers
  *
  * @access public
  *
@@ -399,7 +705,24 @@ bool JSONValue::IsBool() const
  */
 bool JSONValue::IsNumber() const
 {
-    return type == JSONType_Number;
+    return type == JSONType_Number || type == JSONType_Integer;
+}
+
+/**
+ * Checks if the value is an Integer, i.e. a number held exactly as a
+ * 64 bit integer. Parsed numbers are Integers if they have no fraction
+ * or exponent and fit in an int64_t or uint64_t.
+ *
+ * @access public
+ *
+ * @return bool Returns true if it is an Integer value, false otherwise
+ */
+bool JSONValue::IsInteger() const
+{
+    if (type == JSONType_Number && borrowed)
+        return LazyNumber().IsInteger();
+
+    return type == JSONType_Integer;
 }
 
 /**
@@ -428,14 +751,44 @@ bool JSONValue::IsObject() const
 
 /**
  * Retrieves the String value of this JSONValue
+ * Strings borrowed from an arena, ParseView() or ParseInSitu() text have no
+ * std::string to refer to, use AsStringView() for those.
  * Use IsString() before using this method.
  *
  * @access public
  *
- * @return std::string Returns the string value
+ * @return std::string& Returns the string value, or throws JSONException if
+ *                      it's borrowed
  */
 const std::string &JSONValue::AsString() const
 {
+    static const std::string empty_string;
+    if (type != JSONType_String)
+        return empty_string;
+
+    if (borrowed)
+        throw JSONException("Borrowed strings can only be read with AsStringView()");
+
+    return string_value;
+}
+
+/**
+ * Retrieves a view of the String value of this JSONValue
+ * Unlike AsString() this never copies the string.
+ * Use IsString() before using this method.
+ *
+ * @access public
+ *
+ * @return std::string_view Returns the string value, valid as long as this value
+ */
+std::string_view JSONValue::AsStringView() const
+{
+    if (type != JSONType_String)
+        return std::string_view();
+
+    if (borrowed)
+        return std::string_view(string_ref.data, string_ref.size);
+
     return string_value;
 }
 
@@ -449,7 +802,7 @@ const std::string &JSONValue::AsString() const
  */
 bool JSONValue::AsBool() const
 {
-    return bool_value;
+    return type == JSONType_Bool ? bool_value : false;
 }
 
 /**
@@ -462,7 +815,71 @@ bool JSONValue::AsBool() const
  */
 double JSONValue::AsNumber() const
 {
-    return number_value;
+    if (type == JSONType_Number && borrowed)
+        return LazyNumber().AsNumber();
+
+    if (type == JSONType_Integer)
+        return integer_unsigned ? static_cast<double>(unsigned_value) : static_cast<double>(integer_value);
+
+    return type == JSONType_Number ? number_value : 0.0;
+}
+
+/**
+ * Retrieves the Number value of this JSONValue as an int64_t
+ * Fractions are truncated and values out of range are clamped.
+ * Use IsNumber() before using this method.
+ *
+ * @access public
+ *
+ * @return int64_t Returns the number value
+ */
+std::int64_t JSONValue::AsInt64() const
+{
+    if (type == JSONType_Number && borrowed)
+        return LazyNumber().AsInt64();
+
+    if (type == JSONType_Integer)
+        return integer_unsigned ? INT64_MAX : integer_value;
+
+    // Converting an out of range double is undefined, so clamp it first
+    if (type != JSONType_Number || isnan(number_value))
+        return 0;
+    if (number_value <= -9223372036854775808.0)
+        return INT64_MIN;
+    if (number_value >= 9223372036854775808.0)
+        return INT64_MAX;
+
+    return static_cast<std::int64_t>(number_value);
+}
+
+/**
+ * Retrieves the Number value of this JSONValue as a uint64_t
+ * Fractions are truncated and values out of range are clamped.
+ * Use IsNumber() before using this method.
+ *
+ * @access public
+ *
+ * @return uint64_t Returns the number value
+ */
+std::uint64_t JSONValue::AsUInt64() const
+{
+    if (type == JSONType_Number && borrowed)
+        return LazyNumber().AsUInt64();
+
+    if (type == JSONType_Integer)
+    {
+        if (integer_unsigned)
+            return unsigned_value;
+        return integer_value < 0 ? 0 : static_cast<std::uint64_t>(integer_value);
+    }
+
+    // Converting an out of range double is undefined, so clamp it first
+    if (type != JSONType_Number || !(number_value > 0))
+        return 0;
+    if (number_value >= 18446744073709551616.0)
+        return UINT64_MAX;
+
+    return static_cast<std::uint64_t>(number_value);
 }
 
 /**
@@ -475,7 +892,8 @@ double JSONValue::AsNumber() const
  */
 const JSONArray &JSONValue::AsArray() const
 {
-    return array_value;
+    static const JSONArray empty_array;
+    return type == JSONType_Array ? array_value : empty_array;
 }
 
 /**
@@ -488,7 +906,8 @@ const JSONArray &JSONValue::AsArray() const
  */
 const JSONObject &JSONValue::AsObject() const
 {
-    return object_value;
+    static const JSONObject empty_object;
+    return type == JSONType_Object ? object_value : empty_object;
 }
 
 /**
@@ -544,7 +963,7 @@ bool JSONValue::HasChild(std::size_t index) const
  */
 const JSONValue &JSONValue::Child(std::size_t index) const
 {
-    if (index < array_value.size())
+    if (type == JSONType_Array && index < array_value.size())
     {
         return array_value[index];
     }
@@ -562,7 +981,7 @@ const JSONValue &JSONValue::Child(std::size_t index) const
  *
  * @return bool Returns true if the object has a value at the given key.
  */
-bool JSONValue::HasChild(const std::string &name) const
+bool JSONValue::HasChild(std::string_view name) const
 {
     if (type == JSONType_Object)
     {
@@ -583,8 +1002,11 @@ bool JSONValue::HasChild(const std::string &name) const
  * @return JSONValue Returns JSONValue for the given key in the object
  *                   or throw JSONException if it doesn't exist.
  */
-const JSONValue &JSONValue::Child(const std::string &name) const
+const JSONValue &JSONValue::Child(std::string_view name) const
 {
+    if (type != JSONType_Object)
+        throw JSONException();
+
     JSONObject::const_iterator it = object_value.find(name);
     if (it != object_value.end())
     {
@@ -613,7 +1035,7 @@ std::vector<std::string> JSONValue::ObjectKeys() const
         JSONObject::const_iterator iter = object_value.begin();
         while (iter != object_value.end())
         {
-            keys.push_back(iter->first);
+            keys.emplace_back(iter->first);
 
             iter++;
         }
@@ -634,177 +1056,599 @@ std::vector<std::string> JSONValue::ObjectKeys() const
 std::string JSONValue::Stringify(bool const prettyprint) const
 {
     size_t const indentDepth = prettyprint ? 1 : 0;
-    return StringifyImpl(indentDepth);
+
+    // The whole document is written into one buffer
+    std::string ret_string;
+    ret_string.reserve(256);
+    StringifyImpl(ret_string, indentDepth);
+    return ret_string;
+}
+
+
+// Collects output in a fixed size buffer, handing it to a sink whenever it
+// fills, so WriteTo() never holds the whole document in memory. It has the
+// parts of the std::string interface that StringifyImpl() uses.
+class BufferedWriter
+{
+    public:
+        // Writes all the data given, returning false on an error
+        typedef bool (*Sink)(void *target, const char *data, size_t size);
+
+        BufferedWriter(Sink m_sink, void *m_target)
+            : sink(m_sink), target(m_target), buffer(new char[buffer_size]), used(0), ok(true) {}
+
+        void append(const char *data, size_t size)
+        {
+            if (size > buffer_size - used)
+            {
+                Flush();
+
+                // Anything too big for the buffer goes straight to the sink
+                if (size >= buffer_size)
+                {
+                    ok = ok && sink(target, data, size);
+                    return;
+                }
+            }
+
+            memcpy(buffer.get() + used, data, size);
+            used += size;
+        }
+
+        void append(size_t count, char chr)
+        {
+            while (count > 0)
+            {
+                if (used == buffer_size)
+                    Flush();
+
+                size_t run = std::min(count, buffer_size - used);
+                memset(buffer.get() + used, chr, run);
+                used += run;
+                count -= run;
+            }
+        }
+
+        BufferedWriter &operator+=(char chr)
+        {
+            if (used == buffer_size)
+                Flush();
+
+            buffer[used++] = chr;
+            return *this;
+        }
+
+        BufferedWriter &operator+=(const char *str)
+        {
+            append(str, strlen(str));
+            return *this;
+        }
+
+        // Writes out what's left, returning false if any write failed
+        bool Finish()
+        {
+            Flush();
+            return ok;
+        }
+
+    private:
+        static const size_t buffer_size = 64 * 1024;
+
+        void Flush()
+        {
+            if (used > 0)
+                ok = ok && sink(target, buffer.get(), used);
+            used = 0;
+        }
+
+        Sink sink;
+        void *target;
+        std::unique_ptr<char[]> buffer;
+        size_t used;
+        bool ok;
+};
+
+/**
+ * Writes to a std::ostream, for BufferedWriter
+ *
+ * @param void* target The std::ostream
+ * @param char* data The data to write
+ * @param size_t size The number of bytes
+ *
+ * @return bool Returns false if the stream failed
+ */
+static bool WriteToStream(void *target, const char *data, size_t size)
+{
+    std::ostream &stream = *static_cast<std::ostream *>(target);
+    stream.write(data, size);
+    return stream.good();
 }
 
+/**
+ * Writes to a FILE*, for BufferedWriter
+ *
+ * @param void* target The FILE*
+ * @param char* data The data to write
+ * @param size_t size The number of bytes
+ *
+ * @return bool Returns false if not everything could be written
+ */
+static bool WriteToFile(void *target, const char *data, size_t size)
+{
+    return fwrite(data, 1, size, static_cast<FILE *>(target)) == size;
+}
 
 /**
- * Creates a JSON encoded string for the value with all necessary characters escaped
+ * Writes to a file descriptor, for BufferedWriter
+ *
+ * @param void* target Points to the int file descriptor
+ * @param char* data The data to write
+ * @param size_t size The number of bytes
+ *
+ * @return bool Returns false if not everything could be written
+ */
+static bool WriteToDescriptor(void *target, const char *data, size_t size)
+{
+    int fd = *static_cast<int *>(target);
+    while (size > 0)
+    {
+#ifdef _WIN32
+        int written = _write(fd, data, static_cast<unsigned int>(std::min<size_t>(size, INT_MAX)));
+#else
+        ssize_t written = write(fd, data, size);
+#endif
+        if (written < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+
+        data += written;
+        size -= written;
+    }
+
+    return true;
+}
+
+/**
+ * Writes the JSON encoded value to a stream as it's generated, so the
+ * whole document is never held in memory
+ *
+ * @access public
+ *
+ * @param std::ostream stream The stream to write to
+ * @param bool prettyprint Enable prettyprint
+ *
+ * @return bool Returns true on success, false if a write failed
+ */
+bool JSONValue::WriteTo(std::ostream &stream, bool const prettyprint) const
+{
+    BufferedWriter writer(WriteToStream, &stream);
+    StringifyImpl(writer, prettyprint ? 1 : 0);
+    return writer.Finish();
+}
+
+/**
+ * Writes the JSON encoded value to a FILE* as it's generated. The file is
+ * not flushed, the output just goes through its usual buffering.
+ *
+ * @access public
+ *
+ * @param FILE* file The file to write to
+ * @param bool prettyprint Enable prettyprint
+ *
+ * @return bool Returns true on success, false if a write failed
+ */
+bool JSONValue::WriteTo(FILE *file, bool const prettyprint) const
+{
+    BufferedWriter writer(WriteToFile, file);
+    StringifyImpl(writer, prettyprint ? 1 : 0);
+    return writer.Finish();
+}
+
+/**
+ * Writes the JSON encoded value to a file descriptor as it's generated,
+ * in chunks of the writer's buffer size
+ *
+ * @access public
+ *
+ * @param int fd The file descriptor to write to
+ * @param bool prettyprint Enable prettyprint
+ *
+ * @return bool Returns true on success, false if a write failed
+ */
+bool JSONValue::WriteTo(int fd, bool const prettyprint) const
+{
+    BufferedWriter writer(WriteToDescriptor, &fd);
+    StringifyImpl(writer, prettyprint ? 1 : 0);
+    return writer.Finish();
+}
+
+/**
+ * Appends the JSON encoded string for the value with all necessary
+ * characters escaped
  *
  * @access private
  *
+ * @param Output out The string or BufferedWriter to append to
  * @param size_t indentDepth The prettyprint indentation depth (0 : no prettyprint)
- *
- * @return std::string Returns the JSON string
  */
-std::string JSONValue::StringifyImpl(size_t const indentDepth) const
+template <class Output>
+void JSONValue::StringifyImpl(Output &out, size_t const indentDepth) const
 {
-    std::string ret_string;
     size_t const indentDepth1 = indentDepth ? indentDepth + 1 : 0;
-    std::string const indentStr = Indent(indentDepth);
-    std::string const indentStr1 = Indent(indentDepth1);
 
     switch (type)
     {
         case JSONType_Null:
-            ret_string = "null";
+            out += "null";
             break;
 
         case JSONType_String:
-            ret_string = StringifyString(string_value);
+            StringifyString(out, AsStringView());
             break;
 
         case JSONType_Bool:
-            ret_string = bool_value ? "true" : "false";
+            out += bool_value ? "true" : "false";
             break;
 
         case JSONType_Number:
         {
-            if (isinf(number_value) || isnan(number_value))
-                ret_string = "null";
+            // Lazy numbers are written out exactly as they were parsed
+            if (borrowed)
+                out.append(number_ref.data, number_ref.size);
+            else if (isinf(number_value) || isnan(number_value))
+                out += "null";
             else
             {
-                std::stringstream ss;
-                ss.precision(15);
-                ss << number_value;
-                ret_string = ss.str();
+                char digits[SIMPLEJSON_DOUBLE_CHARS];
+                out.append(digits, simplejson_format_double(number_value, digits) - digits);
             }
             break;
         }
 
+        case JSONType_Integer:
+        {
+            char digits[24];
+            std::to_chars_result result = integer_unsigned ?
+                std::to_chars(digits, digits + sizeof(digits), unsigned_value) :
+                std::to_chars(digits, digits + sizeof(digits), integer_value);
+            out.append(digits, result.ptr - digits);
+            break;
+        }
+
         case JSONType_Array:
         {
-            ret_string = indentDepth ? "[\n" + indentStr1 : "[";
+            out += '[';
+            if (indentDepth)
+            {
+                out += '\n';
+                Indent(out, indentDepth1);
+            }
+
             JSONArray::const_iterator iter = array_value.begin();
             while (iter != array_value.end())
             {
-                ret_string += iter->StringifyImpl(indentDepth1);
+                iter->StringifyImpl(out, indentDepth1);
 
                 // Not at the end - add a separator
                 if (++iter != array_value.end())
-                    ret_string += ",";
+                    out += ',';
+            }
+
+            if (indentDepth)
+            {
+                out += '\n';
+                Indent(out, indentDepth);
             }
-            ret_string += indentDepth ? "\n" + indentStr + "]" : "]";
+            out += ']';
             break;
         }
 
         case JSONType_Object:
         {
-            ret_string = indentDepth ? "{\n" + indentStr1 : "{";
+            out += '{';
+            if (indentDepth)
+            {
+                out += '\n';
+                Indent(out, indentDepth1);
+            }
+
             JSONObject::const_iterator iter = object_value.begin();
             while (iter != object_value.end())
             {
-                ret_string += StringifyString((*iter).first);
-                ret_string += ":";
-                ret_string += iter->second.StringifyImpl(indentDepth1);
+                StringifyString(out, (*iter).first);
+                out += ':';
+                iter->second.StringifyImpl(out, indentDepth1);
 
                 // Not at the end - add a separator
                 if (++iter != object_value.end())
-                    ret_string += ",";
+                    out += ',';
             }
-            ret_string += indentDepth ? "\n" + indentStr + "}" : "}";
+
+            if (indentDepth)
+            {
+                out += '\n';
+                Indent(out, indentDepth);
+            }
+            out += '}';
             break;
         }
     }
-
-    return ret_string;
 }
 
 /**
- * Creates a JSON encoded string with all required fields escaped
+ * Appends a JSON encoded string with all required fields escaped
  * Works from http://www.ecma-internationl.org/publications/files/ECMA-ST/ECMA-262.pdf
  * Section 15.12.3.
  *
  * @access private
  *
- * @param std::string str The string that needs to have the characters escaped
- *
- * @return std::string Returns the JSON string
+ * @param Output str_out The string or BufferedWriter to append to
+ * @param std::string_view str The string that needs to have the characters escaped
  */
-std::string JSONValue::StringifyString(const std::string &str)
-{
-	std::string str_out = "\"";
-
-	std::string::const_iterator iter = str.begin();
-	while (iter != str.end())
-	{
-		char chr = *iter;
-
-		if (chr == '"' || chr == '\\' || chr == '/')
-		{
-			str_out += '\\';
-			str_out += chr;
-		}
-		else if (chr == '\b')
-		{
-			str_out += "\\b";
-		}
-		else if (chr == '\f')
-		{
-			str_out += "\\f";
-		}
-		else if (chr == '\n')
-		{
-			str_out += "\\n";
-		}
-		else if (chr == '\r')
-		{
-			str_out += "\\r";
-		}
-		else if (chr == '\t')
-		{
-			str_out += "\\t";
-		}
-        // NOTE: It's not necessary to escape non-ASCII unicode
-        //       characters, just include them like any other character
-		//else if (chr < ' ' || chr > 126)
-		//{
-		//	str_out += "\\u";
-		//	for (int i = 0; i < 4; i++)
-		//	{
-		//		int value = (chr >> 12) & 0xf;
-		//		if (value >= 0 && value <= 9)
-		//			str_out += (char)('0' + value);
-		//		else if (value >= 10 && value <= 15)
-		//			str_out += (char)('A' + (value - 10));
-		//		chr <<= 4;
-		//	}
-		//}
-		else
-		{
-			str_out += chr;
-		}
-
-		iter++;
-	}
-
-	str_out += "\"";
-	return str_out;
-}
-
-/**
- * Creates the indentation string for the depth given
+template <class Output>
+void JSONValue::StringifyString(Output &str_out, std::string_view str)
+{
+    // The letter each control character is escaped with, 0 for \u00XX
+    static const char control_escapes[0x20] = {
+        0, 0, 0, 0, 0, 0, 0, 0, 'b', 't', 'n', 0, 'f', 'r', 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+    };
+    static const char hex_digits[] = "0123456789ABCDEF";
+
+    str_out += '"';
+
+    // Runs of characters that need no escaping (which includes all
+    // non-ASCII unicode characters) are copied as they are
+    const char *ptr = str.data();
+    const char *end = ptr + str.size();
+    while (true)
+    {
+        const char *special = simplejson_find_escape(ptr, end);
+        str_out.append(ptr, special - ptr);
+        if (special == end)
+            break;
+
+        // Quotes and backslashes just get a backslash before them
+        unsigned char chr = static_cast<unsigned char>(*special);
+        if (chr >= 0x20)
+        {
+            char escape[2] = { '\\', static_cast<char>(chr) };
+            str_out.append(escape, 2);
+        }
+        else if (control_escapes[chr] != 0)
+        {
+            char escape[2] = { '\\', control_escapes[chr] };
+            str_out.append(escape, 2);
+        }
+        else
+        {
+            char escape[6] = { '\\', 'u', '0', '0', hex_digits[chr >> 4], hex_digits[chr & 15] };
+            str_out.append(escape, 6);
+        }
+
+        ptr = special + 1;
+    }
+
+    str_out += '"';
+}
+
+/**
+ * Appends the indentation for the depth given
  *
  * @access private
  *
+ * @param Output out The string or BufferedWriter to append to
  * @param size_t indent The prettyprint indentation depth (0 : no indentation)
- *
- * @return std::string Returns the string
  */
-std::string JSONValue::Indent(size_t depth)
+template <class Output>
+void JSONValue::Indent(Output &out, size_t depth)
 {
 	const size_t indent_step = 2;
 	depth ? --depth : 0;
-	std::string indentStr(depth * indent_step, ' ');
-	return indentStr;
+	out.append(depth * indent_step, ' ');
+}
+
+/**
+ * Creates a JSON Value of type String that refers to the given characters
+ * rather than owning a copy of them
+ *
+ * @access private
+ *
+ * @param char* data The characters, which must outlive the value
+ * @param size_t size The number of characters
+ *
+ * @return JSONValue Returns the borrowed string value
+ */
+JSONValue JSONValue::StringRef(const char *data, std::size_t size)
+{
+    JSONValue value;
+    value.type = JSONType_String;
+    value.borrowed = true;
+    value.string_ref.data = data;
+    value.string_ref.size = size;
+    return value;
+}
+
+/**
+ * Creates a JSON Value of type Number that refers to the text of the number
+ * and only converts it when it's read
+ *
+ * @access private
+ *
+ * @param char* data The text of a valid JSON number, which must outlive the value
+ * @param size_t size The number of characters
+ *
+ * @return JSONValue Returns the lazy number value
+ */
+JSONValue JSONValue::NumberRef(const char *data, std::size_t size)
+{
+    JSONValue value;
+    value.type = JSONType_Number;
+    value.borrowed = true;
+    value.number_ref.data = data;
+    value.number_ref.size = size;
+    return value;
+}
+
+/**
+ * Converts a lazy number by parsing its text
+ *
+ * @access private
+ *
+ * @return JSONValue Returns the Number or Integer the text holds
+ */
+JSONValue JSONValue::LazyNumber() const
+{
+    // The text was checked when it was parsed, so this can't fail
+    const char *text = number_ref.data;
+    return JSON::ParseNumber(&text, text + number_ref.size);
+}
+
+/**
+ * Copies the payload of another value into this one
+ * The current payload must have been released with Clear() first
+ *
+ * @access private
+ *
+ * @param JSONValue source The value to copy
+ */
+void JSONValue::CopyFrom(const JSONValue &source)
+{
+    // Copies own their payload, so lazy numbers are converted
+    if (source.type == JSONType_Number && source.borrowed)
+    {
+        JSONValue converted = source.LazyNumber();
+        MoveFrom(converted);
+        return;
+    }
+
+    switch (source.type)
+    {
+        case JSONType_Null:
+            break;
+
+        case JSONType_String:
+            // Copies always own their string
+            if (source.borrowed)
+                new (&string_value) std::string(source.string_ref.data, source.string_ref.size);
+            else
+                new (&string_value) std::string(source.string_value);
+            break;
+
+        case JSONType_Bool:
+            bool_value = source.bool_value;
+            break;
+
+        case JSONType_Number:
+            number_value = source.number_value;
+            break;
+
+        case JSONType_Integer:
+            if (source.integer_unsigned)
+                unsigned_value = source.unsigned_value;
+            else
+                integer_value = source.integer_value;
+            break;
+
+        case JSONType_Array:
+            new (&array_value) JSONArray(source.array_value);
+            break;
+
+        case JSONType_Object:
+            new (&object_value) JSONObject(source.object_value);
+            break;
+    }
+
+    // Only now the payload exists, in case the copy threw
+    type = source.type;
+    integer_unsigned = source.integer_unsigned;
+}
+
+/**
+ * Moves the payload of another value into this one, leaving the source NULL
+ * The current payload must have been released with Clear() first
+ *
+ * @access private
+ *
+ * @param JSONValue source The value to take the payload from
+ */
+void JSONValue::MoveFrom(JSONValue &source) noexcept
+{
+    switch (source.type)
+    {
+        case JSONType_Null:
+            break;
+
+        case JSONType_String:
+            if (source.borrowed)
+                string_ref = source.string_ref;
+            else
+                new (&string_value) std::string(std::move(source.string_value));
+            break;
+
+        case JSONType_Bool:
+            bool_value = source.bool_value;
+            break;
+
+        case JSONType_Number:
+            if (source.borrowed)
+                number_ref = source.number_ref;
+            else
+                number_value = source.number_value;
+            break;
+
+        case JSONType_Integer:
+            if (source.integer_unsigned)
+                unsigned_value = source.unsigned_value;
+            else
+                integer_value = source.integer_value;
+            break;
+
+        case JSONType_Array:
+            new (&array_value) JSONArray(std::move(source.array_value));
+            break;
+
+        case JSONType_Object:
+            new (&object_value) JSONObject(std::move(source.object_value));
+            break;
+    }
+
+    type = source.type;
+    borrowed = source.borrowed;
+    integer_unsigned = source.integer_unsigned;
+    source.Clear();
+}
+
+/**
+ * Destroys the current payload and leaves the value as NULL
+ *
+ * @access private
+ */
+void JSONValue::Clear()
+{
+    switch (type)
+    {
+        case JSONType_String:
+            if (!borrowed)
+                string_value.~basic_string();
+            break;
+
+        case JSONType_Array:
+            array_value.~JSONArray();
+            break;
+
+        case JSONType_Object:
+            object_value.~JSONObject();
+            break;
+
+        default:
+            break;
+    }
+
+    type = JSONType_Null;
+    borrowed = false;
+    integer_unsigned = false;
 }
@@ -27,12 +27,17 @@
 
 #include <vector>
 #include <string>
+#include <string_view>
+#include <cstdint>
+#include <cstdio>
+#include <iosfwd>
 
 #include "JSON.h"
 
 class JSON;
+class JSONStructuralIndex;
 
-enum JSONType { JSONType_Null, JSONType_String, JSONType_Bool, JSONType_Number, JSONType_Array, JSONType_Object };
+enum JSONType { JSONType_Null, JSONType_String, JSONType_Bool, JSONType_Number, JSONType_Array, JSONType_Object, JSONType_Integer };
 
 class JSONValue
 {
@@ -42,49 +47,103 @@ class JSONValue
         JSONValue(/*NULL*/);
         JSONValue(const char *m_char_value);
         JSONValue(const std::string &m_string_value);
+        JSONValue(std::string &&m_string_value);
         JSONValue(bool m_bool_value);
         JSONValue(double m_number_value);
         JSONValue(int m_integer_value);
+        JSONValue(std::int64_t m_integer_value);
+        JSONValue(std::uint64_t m_integer_value);
         JSONValue(const JSONArray &m_array_value);
+        JSONValue(JSONArray &&m_array_value);
         JSONValue(const JSONObject &m_object_value);
+        JSONValue(JSONObject &&m_object_value);
+        JSONValue(const JSONValue &m_source);
+        JSONValue(JSONValue &&m_source) noexcept;
+        ~JSONValue();
+
+        JSONValue &operator=(const JSONValue &m_source);
+        JSONValue &operator=(JSONValue &&m_source) noexcept;
 
         bool IsNull() const;
         bool IsString() const;
         bool IsBool() const;
         bool IsNumber() const;
+        bool IsInteger() const;
         bool IsArray() const;
         bool IsObject() const;
 
         const std::string &AsString() const;
+        std::string_view AsStringView() const;
         bool AsBool() const;
         double AsNumber() const;
+        std::int64_t AsInt64() const;
+        std::uint64_t AsUInt64() const;
         const JSONArray &AsArray() const;
         const JSONObject &AsObject() const;
 
         std::size_t CountChildren() const;
         bool HasChild(std::size_t index) const;
         const JSONValue &Child(std::size_t index) const;
-        bool HasChild(const std::string &name) const;
-        const JSONValue &Child(const std::string &name) const;
+        bool HasChild(std::string_view name) const;
+        const JSONValue &Child(std::string_view name) const;
         std::vector<std::string> ObjectKeys() const;
 
         std::string Stringify(bool const prettyprint = false) const;
+        bool WriteTo(std::ostream &stream, bool const prettyprint = false) const;
+        bool WriteTo(FILE *file, bool const prettyprint = false) const;
+        bool WriteTo(int fd, bool const prettyprint = false) const;
     protected:
-        static JSONValue Parse(const char **data);
+        static JSONValue Parse(const char **data, const char *end, JSONParseContext &context);
+        static JSONValue ParseIndexed(JSONStructuralIndex &index, JSONParseContext &context);
 
     private:
-        static std::string StringifyString(const std::string &str);
-        std::string StringifyImpl(size_t const indentDepth) const;
-        static std::string Indent(size_t depth);
+        static JSONValue StringRef(const char *data, std::size_t size);
+        static JSONValue NumberRef(const char *data, std::size_t size);
+        JSONValue LazyNumber() const;
+        template <class Output> static void StringifyString(Output &out, std::string_view str);
+        template <class Output> void StringifyImpl(Output &out, size_t const indentDepth) const;
+        template <class Output> static void Indent(Output &out, size_t depth);
 
-        JSONType type;
+        void CopyFrom(const JSONValue &source);
+        void MoveFrom(JSONValue &source) noexcept;
+        void Clear();
 
-        bool bool_value;
-        double number_value;
-        std::string string_value;
-        JSONArray array_value;
-        JSONObject object_value;
+        JSONType type;
 
+        // The payload points at memory the value doesn't own, e.g. an arena
+        bool borrowed = false;
+
+        // An Integer above INT64_MAX, held in unsigned_value
+        bool integer_unsigned = false;
+
+        // A string held by reference to characters the value doesn't own
+        struct StringRefValue
+        {
+            const char *data;
+            std::size_t size;
+        };
+
+        // A number held as its text, converted each time it's read so that
+        // reading never writes to the value
+        struct NumberRefValue
+        {
+            const char *data;
+            std::size_t size;
+        };
+
+        // Only the member matching 'type' (and 'borrowed') is alive
+        union
+        {
+            bool bool_value;
+            double number_value;
+            std::int64_t integer_value;
+            std::uint64_t unsigned_value;
+            std::string string_value;
+            StringRefValue string_ref;
+            NumberRefValue number_ref;
+            JSONArray array_value;
+            JSONObject object_value;
+        };
 };
 
 #endif
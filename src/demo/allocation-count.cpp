@@ -0,0 +1,108 @@
+/*
+ * File demo/allocation-count.cpp part of the SimpleJSON Library Demo - http://mjpa.in/json
+ *
+ * Copyright (C) 2010 Mike Anchor
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * Counts every heap allocation made by the process for the benchmarks.
+ * Only linked into JSONBenchmark, so the demo and its tests run with the
+ * standard operators.
+ */
+
+#include <new>
+#include <atomic>
+#include <cstdlib>
+#include "functions.h"
+
+using namespace std;
+
+static atomic<size_t> allocation_count(0);
+static atomic<size_t> allocation_bytes(0);
+
+// Reads the totals so far
+static void read_counts(size_t &count, size_t &bytes)
+{
+	count = allocation_count;
+	bytes = allocation_bytes;
+}
+
+// Hands read_counts() to the benchmarks before main() runs
+static struct RegisterCounts
+{
+	RegisterCounts() { read_allocation_counts = read_counts; }
+} register_counts;
+
+// Counts and makes an allocation, or returns 0 if there's no memory
+static void *counted_alloc(size_t size, size_t alignment)
+{
+	allocation_count++;
+	allocation_bytes += size;
+
+	if (size == 0)
+		size = 1;
+
+	// aligned_alloc() wants a multiple of the alignment
+	if (alignment > alignof(max_align_t))
+		return aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+
+	return malloc(size);
+}
+
+// Makes an allocation or throws bad_alloc as operator new must
+static void *counted_new(size_t size, size_t alignment)
+{
+	void *ptr = counted_alloc(size, alignment);
+	if (ptr == 0)
+		throw bad_alloc();
+	return ptr;
+}
+
+void *operator new(size_t size) { return counted_new(size, 0); }
+void *operator new[](size_t size) { return counted_new(size, 0); }
+void *operator new(size_t size, const nothrow_t &) noexcept { return counted_alloc(size, 0); }
+void *operator new[](size_t size, const nothrow_t &) noexcept { return counted_alloc(size, 0); }
+
+void *operator new(size_t size, align_val_t alignment) { return counted_new(size, static_cast<size_t>(alignment)); }
+void *operator new[](size_t size, align_val_t alignment) { return counted_new(size, static_cast<size_t>(alignment)); }
+void *operator new(size_t size, align_val_t alignment, const nothrow_t &) noexcept
+{
+	return counted_alloc(size, static_cast<size_t>(alignment));
+}
+void *operator new[](size_t size, align_val_t alignment, const nothrow_t &) noexcept
+{
+	return counted_alloc(size, static_cast<size_t>(alignment));
+}
+
+// Everything above came from malloc() or aligned_alloc(), so free() releases it all
+void operator delete(void *ptr) noexcept { free(ptr); }
+void operator delete[](void *ptr) noexcept { free(ptr); }
+void operator delete(void *ptr, size_t) noexcept { free(ptr); }
+void operator delete[](void *ptr, size_t) noexcept { free(ptr); }
+void operator delete(void *ptr, const nothrow_t &) noexcept { free(ptr); }
+void operator delete[](void *ptr, const nothrow_t &) noexcept { free(ptr); }
+
+void operator delete(void *ptr, align_val_t) noexcept { free(ptr); }
+void operator delete[](void *ptr, align_val_t) noexcept { free(ptr); }
+void operator delete(void *ptr, size_t, align_val_t) noexcept { free(ptr); }
+void operator delete[](void *ptr, size_t, align_val_t) noexcept { free(ptr); }
+void operator delete(void *ptr, align_val_t, const nothrow_t &) noexcept { free(ptr); }
+void operator delete[](void *ptr, align_val_t, const nothrow_t &) noexcept { free(ptr); }
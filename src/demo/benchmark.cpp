@@ -0,0 +1,697 @@
+/*
+ * File demo/benchmark.cpp part of the SimpleJSON Library Demo - http://mjpa.in/json
+ *
+ * Copyright (C) 2010 Mike Anchor
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * Rough benchmarks for the library, the numbers are only meaningful when
+ * compared against each other on the same machine.
+ */
+
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <iomanip>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+#include <map>
+#include <vector>
+#include "../JSON.h"
+#include "../JSONSimd.h"
+#include "../JSONFlatMap.h"
+#include "../JSONReader.h"
+#include "../JSONIncrementalParser.h"
+#include "functions.h"
+
+// Set to the width of the description column
+#define DESC_LENGTH	50
+
+// Number of records in the generated documents
+#define RECORD_COUNT	100000
+
+// Number of records / repeats for the small document benchmarks
+#define SMALL_RECORD_COUNT	1000
+#define SMALL_REPEATS		100
+
+// Number of lookups timed for each object size
+#define LOOKUP_COUNT	1000000
+
+using namespace std;
+
+// Set by allocation-count.cpp in the JSONBenchmark build
+void (*read_allocation_counts)(size_t &count, size_t &bytes) = 0;
+
+// Helper to get the heap allocations made so far, both 0 if they aren't counted
+static void allocations_so_far(size_t &count, size_t &bytes)
+{
+	count = bytes = 0;
+	if (read_allocation_counts != 0)
+		read_allocation_counts(count, bytes);
+}
+
+// Helper to get the resident set size of the process in KB (0 if unknown)
+static size_t resident_kb()
+{
+	ifstream in("/proc/self/statm");
+	size_t pages = 0, resident = 0;
+	if (!(in >> pages >> resident))
+		return 0;
+
+	return resident * 4;
+}
+
+// Helper to get the time since the given point in milliseconds
+static double elapsed_ms(const chrono::steady_clock::time_point &start)
+{
+	return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+// Helper to print a single row of results
+static void print_row(const string &name, const string &result)
+{
+	ostringstream stream;
+	stream.setf(ios_base::left, ios_base::adjustfield);
+	stream << "| " << setw(DESC_LENGTH) << name << " | " << setw(20) << result << " |\r\n";
+	print_out(stream.str().c_str());
+}
+
+// Builds a document of records with long, descriptive keys like those
+// of typical API responses
+static string make_long_keys_document(int count)
+{
+	ostringstream stream;
+	stream << "[";
+	for (int i = 0; i < count; i++)
+	{
+		if (i) stream << ",";
+		stream << "{\"customer_identifier\":" << i << ",\"account_display_name\":\"user" << i
+		       << "\",\"last_login_timestamp\":" << 1600000000 + i << ",\"preferred_language_code\":\"en\""
+		       << ",\"notification_settings\":{\"email_notifications\":true,\"push_notifications\":false}"
+		       << ",\"subscription_tier\":\"basic\"}";
+	}
+	stream << "]";
+	return stream.str();
+}
+
+// Builds a document of small records with a mix of value types
+static string make_records_document(int count)
+{
+	ostringstream stream;
+	stream << "[";
+	for (int i = 0; i < count; i++)
+	{
+		if (i) stream << ",";
+		stream << "{\"id\":" << i << ",\"name\":\"record " << i << "\",\"score\":" << (i % 1000) / 8.0
+		       << ",\"active\":" << (i % 2 ? "true" : "false") << ",\"parent\":null"
+		       << ",\"tags\":[\"a\",\"b\",\"c\"],\"point\":[" << i % 360 << "," << i % 180 << "]}";
+	}
+	stream << "]";
+	return stream.str();
+}
+
+// Builds a document of records dominated by long string fields
+static string make_strings_document(int count)
+{
+	ostringstream stream;
+	stream << "[";
+	for (int i = 0; i < count; i++)
+	{
+		if (i) stream << ",";
+		stream << "{\"level\":\"info\",\"host\":\"worker-" << i % 16 << ".example.internal\""
+		       << ",\"message\":\"request " << i << " completed after retrying the upstream connection pool\""
+		       << ",\"path\":\"/api/v2/accounts/" << i << "/transactions?page=" << i % 10 << "\""
+		       << ",\"note\":\"quoted \\\"value\\\" here\"}";
+	}
+	stream << "]";
+	return stream.str();
+}
+
+// Builds a document of long string values, mostly free of escapes
+static string make_long_strings_document(int count)
+{
+	string text;
+	for (int i = 0; i < 40; i++)
+		text += "lorem ipsum dolor sit amet ";
+
+	ostringstream stream;
+	stream << "[";
+	for (int i = 0; i < count; i++)
+	{
+		if (i) stream << ",";
+		stream << "{\"id\":\"" << i << "\",\"body\":\"" << text << "\",\"tail\":\"" << text << "\\n" << i << "\"}";
+	}
+	stream << "]";
+	return stream.str();
+}
+
+// Builds a document of multilingual text written with \\u escapes
+static string make_escaped_unicode_document(int count)
+{
+	ostringstream stream;
+	stream << "[";
+	for (int i = 0; i < count; i++)
+	{
+		if (i) stream << ",";
+		stream << "{\"fr\":\"caf\\u00e9 cr\\u00e8me br\\u00fbl\\u00e9e " << i << "\""
+		       << ",\"ru\":\"\\u041f\\u0440\\u0438\\u0432\\u0435\\u0442 \\u043c\\u0438\\u0440\""
+		       << ",\"ja\":\"\\u3053\\u3093\\u306b\\u3061\\u306f\\u4e16\\u754c\""
+		       << ",\"emoji\":\"\\ud83d\\ude00 \\ud83c\\udf89\"}";
+	}
+	stream << "]";
+	return stream.str();
+}
+
+// Builds a document of coordinate pairs, as found in GeoJSON
+static string make_coordinates_document(int count)
+{
+	ostringstream stream;
+	stream << setprecision(17) << "[";
+	for (int i = 0; i < count; i++)
+	{
+		if (i) stream << ",";
+		stream << "[" << -180.0 + (i * 7919 % 360000) / 1000.0 + 1.0 / (i + 3)
+		       << "," << -90.0 + (i * 104729 % 180000) / 1000.0 - 1.0 / (i + 7) << "]";
+	}
+	stream << "]";
+	return stream.str();
+}
+
+// Builds a document of 64 bit IDs, most of them above 2^53
+static string make_ids_document(int count)
+{
+	ostringstream stream;
+	stream << "[";
+	for (int i = 0; i < count; i++)
+	{
+		if (i) stream << ",";
+		stream << 1234567890123456789ULL + (unsigned long long)i * 7919;
+	}
+	stream << "]";
+	return stream.str();
+}
+
+// Builds a document of records nested a few levels deep
+static string make_nested_document(int count)
+{
+	ostringstream stream;
+	stream << "[";
+	for (int i = 0; i < count; i++)
+	{
+		if (i) stream << ",";
+		for (int depth = 0; depth < 8; depth++)
+			stream << "{\"level" << depth << "\":";
+		stream << "{\"id\":" << i << ",\"values\":[" << i % 7 << "," << i % 11 << "]}";
+		stream << string(8, '}');
+	}
+	stream << "]";
+	return stream.str();
+}
+
+// Parse + stringify a document, reporting time and memory
+static void benchmark_document(const string &name, const string &data)
+{
+	ostringstream result;
+
+	size_t rss_before = resident_kb();
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	JSONValue value = JSON::Parse(data);
+	double parse_ms = elapsed_ms(start);
+	size_t rss_after = resident_kb();
+
+	result << fixed << setprecision(1) << parse_ms << " ms";
+	print_row(name + ": parse", result.str());
+
+	result.str("");
+	result << (rss_after - rss_before) << " KB";
+	print_row(name + ": resident memory of tree", result.str());
+
+	start = chrono::steady_clock::now();
+	string output = value.Stringify();
+	double stringify_ms = elapsed_ms(start);
+	size_t output_size = output.size();
+
+	result.str("");
+	result << fixed << setprecision(1) << stringify_ms << " ms";
+	print_row(name + ": stringify", result.str());
+
+	start = chrono::steady_clock::now();
+	output = value.Stringify(true);
+	stringify_ms = elapsed_ms(start);
+
+	result.str("");
+	result << fixed << setprecision(1) << stringify_ms << " ms";
+	print_row(name + ": stringify (pretty)", result.str());
+
+	// Streaming out only needs the writer's buffer, not the whole text
+	FILE *null_file = fopen("/dev/null", "w");
+	if (null_file != 0)
+	{
+		size_t allocations, allocated_bytes;
+		allocations_so_far(allocations, allocated_bytes);
+		start = chrono::steady_clock::now();
+		value.WriteTo(null_file);
+		double write_ms = elapsed_ms(start);
+		fclose(null_file);
+
+		result.str("");
+		result << fixed << setprecision(1) << write_ms << " ms";
+		print_row(name + ": WriteTo(/dev/null)", result.str());
+
+		if (read_allocation_counts != 0)
+		{
+			size_t allocations_after, allocated_bytes_after;
+			allocations_so_far(allocations_after, allocated_bytes_after);
+			result.str("");
+			result << (allocated_bytes_after - allocated_bytes) / 1024 << " KB";
+			print_row(name + ": WriteTo(/dev/null) allocated", result.str());
+		}
+
+		result.str("");
+		result << output_size / 1024 << " KB";
+		print_row(name + ": Stringify() output", result.str());
+	}
+}
+
+// Parses a document with ParseParallel() on 1 to 32 threads
+static void benchmark_parallel(const string &name, const string &data)
+{
+	for (unsigned int threads = 1; threads <= 32; threads *= 2)
+	{
+		chrono::steady_clock::time_point start = chrono::steady_clock::now();
+		JSON::ParseParallel(data, threads);
+		double total_ms = elapsed_ms(start);
+
+		ostringstream result;
+		result << fixed << setprecision(1) << total_ms << " ms";
+		print_row(name + " (" + to_string(threads) + (threads == 1 ? " thread)" : " threads)"), result.str());
+	}
+}
+
+// Parses a JSON Lines text one line at a time on this thread, the way it
+// was done before ParseLines()
+static size_t parse_lines_serially(const string &data)
+{
+	size_t count = 0;
+	istringstream stream(data);
+	string line;
+	while (getline(stream, line))
+	{
+		if (!line.empty())
+		{
+			JSON::Parse(line);
+			count++;
+		}
+	}
+	return count;
+}
+
+// Parses a JSON Lines text of records serially and with ParseLines() on
+// different numbers of threads
+static void benchmark_lines(const string &name, const string &data)
+{
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	parse_lines_serially(data);
+	double total_ms = elapsed_ms(start);
+
+	ostringstream result;
+	result << fixed << setprecision(1) << (data.size() / 1048576.0) / (total_ms / 1000.0) << " MB/s";
+	print_row(name + " (line by line)", result.str());
+
+	unsigned int cores = max(1u, thread::hardware_concurrency());
+	for (unsigned int threads = 1; threads <= cores * 2 && threads <= 64; threads *= 2)
+	{
+		start = chrono::steady_clock::now();
+		JSON::ParseLines(data, [](size_t, JSONValue &&) {}, threads);
+		total_ms = elapsed_ms(start);
+
+		result.str("");
+		result << fixed << setprecision(1) << (data.size() / 1048576.0) / (total_ms / 1000.0) << " MB/s";
+		print_row(name + " (ParseLines, " + to_string(threads) + (threads == 1 ? " thread)" : " threads)"), result.str());
+	}
+}
+
+// The ways a document can be parsed
+enum ParseMode { ParseMode_Heap, ParseMode_Arena, ParseMode_View, ParseMode_ViewArena, ParseMode_InSitu, ParseMode_LazyNumbers,
+                 ParseMode_InternedKeys, ParseMode_ArenaInternedKeys, ParseMode_Events,
+                 ParseMode_Reader, ParseMode_Chunks };
+
+// Shared by every parse that interns its keys, as a long running process would
+static JSONKeyPool key_pool;
+
+// Reused between documents, as a connection's parser would be
+static JSON::IncrementalParser incremental_parser;
+
+// Handler that only counts the values, as a reader that picks a few out would
+class CountingHandler : public JSONHandler
+{
+	public:
+		CountingHandler() : values(0) {}
+
+		bool Null() { values++; return true; }
+		bool Bool(bool) { values++; return true; }
+		bool Number(double) { values++; return true; }
+		bool String(string_view) { values++; return true; }
+
+		int values;
+};
+
+// Sums the values of the "id" keys with a JSONReader, skipping every
+// other value whole, as a decoder after a few fields would
+static JSONValue sum_ids(const string &data)
+{
+	JSONReader reader(data.data(), data.size());
+	std::int64_t sum = 0;
+	while (reader.Next())
+	{
+		if (reader.TokenType() != JSONToken_Key)
+			continue;
+
+		if (reader.GetString() != "id")
+			reader.SkipValue();
+		else if (reader.Next() && reader.TokenType() == JSONToken_Number)
+			sum += reader.GetInt64();
+	}
+	return JSONValue(sum);
+}
+
+// Helper to parse a document with the given mode, in situ parses use a
+// copy of the document in the buffer given
+static JSONValue parse_with_mode(ParseMode mode, const string &data, JSONArena &arena, string &buffer)
+{
+	switch (mode)
+	{
+		case ParseMode_Arena: return JSON::Parse(data, arena);
+		case ParseMode_View: return JSON::ParseView(data.c_str());
+		case ParseMode_ViewArena: return JSON::ParseView(data.c_str(), arena);
+		case ParseMode_LazyNumbers: return JSON::ParseView(data.c_str(), arena, JSONParse_LazyNumbers);
+		case ParseMode_InternedKeys: return JSON::Parse(data, key_pool);
+		case ParseMode_ArenaInternedKeys: return JSON::Parse(data, arena, key_pool);
+		case ParseMode_InSitu:
+			buffer.assign(data);
+			return JSON::ParseInSitu(&buffer[0], buffer.size(), arena);
+		case ParseMode_Events:
+		{
+			CountingHandler handler;
+			JSON::ParseEvents(data.data(), data.size(), handler);
+			return JSONValue(handler.values);
+		}
+		case ParseMode_Reader: return sum_ids(data);
+		case ParseMode_Chunks:
+		{
+			// Handed over 4 KB at a time, as reads from a socket would be
+			for (size_t offset = 0; offset < data.size(); offset += 4096)
+				incremental_parser.Feed(data.data() + offset, min<size_t>(4096, data.size() - offset));
+			return incremental_parser.Finish();
+		}
+		default: return JSON::Parse(data);
+	}
+}
+
+// Repeatedly parse a small document with a parse mode, reporting the
+// allocations and throughput
+static void benchmark_parse_mode(const string &name, const string &data, ParseMode mode)
+{
+	// Warm up first so arena blocks are kept and the numbers show the steady state
+	JSONArena arena;
+	string buffer;
+	parse_with_mode(mode, data, arena, buffer);
+	arena.Reset();
+
+	size_t allocations, allocated_bytes;
+	allocations_so_far(allocations, allocated_bytes);
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	for (int i = 0; i < SMALL_REPEATS; i++)
+	{
+		parse_with_mode(mode, data, arena, buffer);
+		arena.Reset();
+	}
+	double total_ms = elapsed_ms(start);
+
+	ostringstream result;
+	if (read_allocation_counts != 0)
+	{
+		size_t allocations_after, allocated_bytes_after;
+		allocations_so_far(allocations_after, allocated_bytes_after);
+		result << (allocations_after - allocations) / SMALL_REPEATS << " / "
+		       << (allocated_bytes_after - allocated_bytes) / SMALL_REPEATS / 1024 << " KB";
+		print_row(name + ": allocations / doc", result.str());
+		result.str("");
+	}
+
+	result << fixed << setprecision(1) << (data.size() * SMALL_REPEATS / 1048576.0) / (total_ms / 1000.0) << " MB/s";
+	print_row(name + ": throughput", result.str());
+}
+
+// Repeatedly parse and stringify a small document with a parse mode, as
+// a filter that forwards what it parses would
+static void benchmark_round_trip(const string &name, const string &data, ParseMode mode)
+{
+	JSONArena arena;
+	string buffer;
+
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	for (int i = 0; i < SMALL_REPEATS; i++)
+	{
+		parse_with_mode(mode, data, arena, buffer).Stringify();
+		arena.Reset();
+	}
+	double total_ms = elapsed_ms(start);
+
+	ostringstream result;
+	result << fixed << setprecision(1) << (data.size() * SMALL_REPEATS / 1048576.0) / (total_ms / 1000.0) << " MB/s";
+	print_row(name + ": round trip", result.str());
+}
+
+// Repeatedly parse a small document with each parse mode
+static void benchmark_parse_modes(const string &name, const string &data)
+{
+	benchmark_parse_mode(name + " (heap)", data, ParseMode_Heap);
+	benchmark_parse_mode(name + " (arena)", data, ParseMode_Arena);
+	benchmark_parse_mode(name + " (view)", data, ParseMode_View);
+	benchmark_parse_mode(name + " (view+arena)", data, ParseMode_ViewArena);
+	benchmark_parse_mode(name + " (in situ+arena)", data, ParseMode_InSitu);
+	benchmark_parse_mode(name + " (events)", data, ParseMode_Events);
+	benchmark_parse_mode(name + " (reader)", data, ParseMode_Reader);
+}
+
+// Repeatedly parse and stringify a document at each SIMD level, taking
+// the best of a few runs as the differences are small next to the noise
+static void benchmark_simd_levels(const string &name, const string &data)
+{
+	JSONSimdLevel best_level = simplejson_simd_level();
+	const char *level_names[] = { "scalar", "SSE2", "AVX2" };
+
+	for (int level = JSONSimd_Scalar; level <= best_level; level++)
+	{
+		simplejson_set_simd_level((JSONSimdLevel)level);
+
+		double parse_ms = 0;
+		for (int run = 0; run < 5; run++)
+		{
+			chrono::steady_clock::time_point start = chrono::steady_clock::now();
+			for (int i = 0; i < SMALL_REPEATS; i++)
+				JSON::Parse(data);
+			double total_ms = elapsed_ms(start);
+			parse_ms = run == 0 || total_ms < parse_ms ? total_ms : parse_ms;
+		}
+
+		ostringstream result;
+		result << fixed << setprecision(1) << (data.size() * SMALL_REPEATS / 1048576.0) / (parse_ms / 1000.0) << " MB/s";
+		print_row(name + " (" + level_names[level] + "): parse", result.str());
+
+		// Parsing by walking the structural characters is only done with SIMD
+		if (level != JSONSimd_Scalar)
+		{
+			double indexed_ms = 0;
+			for (int run = 0; run < 5; run++)
+			{
+				chrono::steady_clock::time_point start = chrono::steady_clock::now();
+				for (int i = 0; i < SMALL_REPEATS; i++)
+					JSON::Parse(data.data(), data.size(), JSONParse_Indexed);
+				double total_ms = elapsed_ms(start);
+				indexed_ms = run == 0 || total_ms < indexed_ms ? total_ms : indexed_ms;
+			}
+
+			result.str("");
+			result << fixed << setprecision(1) << (data.size() * SMALL_REPEATS / 1048576.0) / (indexed_ms / 1000.0) << " MB/s";
+			print_row(name + " (" + level_names[level] + "): indexed parse", result.str());
+		}
+
+		// Finding the structural characters alone, which indexed parsing
+		// does first
+		vector<uint32_t> index(data.size());
+		double index_ms = 0;
+		for (int run = 0; run < 5; run++)
+		{
+			chrono::steady_clock::time_point start = chrono::steady_clock::now();
+			for (int i = 0; i < SMALL_REPEATS; i++)
+			{
+				JSONStructuralState state;
+				simplejson_structural_index(data.data(), data.size(), state, index.data());
+			}
+			double total_ms = elapsed_ms(start);
+			index_ms = run == 0 || total_ms < index_ms ? total_ms : index_ms;
+		}
+
+		result.str("");
+		result << fixed << setprecision(1) << (data.size() * SMALL_REPEATS / 1048576.0) / (index_ms / 1000.0) << " MB/s";
+		print_row(name + " (" + level_names[level] + "): index", result.str());
+
+		JSONValue value = JSON::Parse(data);
+		size_t output_size = value.Stringify().size();
+		double stringify_ms = 0;
+		for (int run = 0; run < 5; run++)
+		{
+			chrono::steady_clock::time_point start = chrono::steady_clock::now();
+			for (int i = 0; i < SMALL_REPEATS; i++)
+				value.Stringify();
+			double total_ms = elapsed_ms(start);
+			stringify_ms = run == 0 || total_ms < stringify_ms ? total_ms : stringify_ms;
+		}
+
+		result.str("");
+		result << fixed << setprecision(1) << (output_size * SMALL_REPEATS / 1048576.0) / (stringify_ms / 1000.0) << " MB/s";
+		print_row(name + " (" + level_names[level] + "): stringify", result.str());
+	}
+
+	simplejson_set_simd_level(best_level);
+}
+
+// Time looking up every key of an object in turn, the keys are searched
+// with a string_view so neither map allocates
+template <class Map>
+static double lookup_ns(const Map &object, const vector<string> &keys)
+{
+	double best_ms = 0;
+	size_t found = 0;
+	for (int run = 0; run < 3; run++)
+	{
+		chrono::steady_clock::time_point start = chrono::steady_clock::now();
+		for (size_t i = 0; i < LOOKUP_COUNT; i++)
+			found += object.find(string_view(keys[i % keys.size()])) != object.end();
+		double total_ms = elapsed_ms(start);
+		best_ms = run == 0 || total_ms < best_ms ? total_ms : best_ms;
+	}
+
+	// Stops the lookups being optimised away
+	if (found == 0)
+		print_out("");
+
+	return best_ms * 1000000.0 / LOOKUP_COUNT;
+}
+
+// Compare looking up keys in std::map (the JSONObject used with
+// SIMPLEJSON_SORTED_OBJECTS) against JSONFlatMap (the default JSONObject)
+static void benchmark_object_lookup(int key_count)
+{
+	map<string, JSONValue, less<> > tree_object;
+	JSONFlatMap<JSONValue> flat_object;
+	vector<string> keys;
+
+	for (int i = 0; i < key_count; i++)
+	{
+		ostringstream key;
+		key << "property_" << (i * 7919) % key_count;
+		keys.push_back(key.str());
+		tree_object[key.str()] = JSONValue(i);
+		flat_object[key.str()] = JSONValue(i);
+	}
+
+	ostringstream name;
+	name << "Object lookup, " << key_count << " keys";
+
+	ostringstream result;
+	result << fixed << setprecision(1) << lookup_ns(tree_object, keys) << " ns";
+	print_row(name.str() + " (map)", result.str());
+
+	result.str("");
+	result << fixed << setprecision(1) << lookup_ns(flat_object, keys) << " ns";
+	print_row(name.str() + " (flat)", result.str());
+}
+
+// Benchmarks to run
+void run_benchmarks()
+{
+	string vert_sep = string("+-") + string(DESC_LENGTH, '-') + string("-+-") + string(20, '-') + string("-+\r\n");
+
+	print_out(vert_sep.c_str());
+	print_row("Benchmark", "Result");
+	print_out(vert_sep.c_str());
+
+	ostringstream result;
+	result << sizeof(JSONValue) << " bytes";
+	print_row("sizeof(JSONValue)", result.str());
+
+	string records = make_records_document(RECORD_COUNT);
+	result.str("");
+	result << records.size() / 1024 << " KB";
+	print_row("Records document size", result.str());
+
+	benchmark_document("Records", records);
+	benchmark_parallel("Records: ParseParallel()", records);
+
+	benchmark_document("Integer IDs", make_ids_document(RECORD_COUNT * 10));
+
+	// The records document with one record per line
+	string lines = records.substr(1, records.size() - 2);
+	for (size_t i = lines.find("},{"); i != string::npos; i = lines.find("},{", i))
+		lines.replace(++i, 1, "\n");
+	benchmark_lines("JSON Lines records", lines);
+
+	string small_records = make_records_document(SMALL_RECORD_COUNT);
+	benchmark_parse_modes("Small records", small_records);
+
+	string small_strings = make_strings_document(SMALL_RECORD_COUNT);
+	benchmark_parse_modes("Small strings", small_strings);
+
+	benchmark_parse_mode("Small records (4 KB chunks)", small_records, ParseMode_Chunks);
+	benchmark_parse_mode("Small strings (4 KB chunks)", small_strings, ParseMode_Chunks);
+
+	string long_keys = make_long_keys_document(SMALL_RECORD_COUNT);
+	benchmark_parse_mode("Long keys (heap)", long_keys, ParseMode_Heap);
+	benchmark_parse_mode("Long keys (interned keys)", long_keys, ParseMode_InternedKeys);
+	benchmark_parse_mode("Long keys (arena)", long_keys, ParseMode_Arena);
+	benchmark_parse_mode("Long keys (arena+interned keys)", long_keys, ParseMode_ArenaInternedKeys);
+
+	string coordinates = make_coordinates_document(SMALL_RECORD_COUNT * 10);
+	benchmark_parse_mode("Coordinates (heap)", coordinates, ParseMode_Heap);
+	benchmark_parse_mode("Coordinates (arena)", coordinates, ParseMode_Arena);
+	benchmark_parse_mode("Coordinates (lazy numbers)", coordinates, ParseMode_LazyNumbers);
+	benchmark_round_trip("Coordinates (view+arena)", coordinates, ParseMode_ViewArena);
+	benchmark_round_trip("Coordinates (lazy numbers)", coordinates, ParseMode_LazyNumbers);
+
+	string escaped_unicode = make_escaped_unicode_document(SMALL_RECORD_COUNT);
+	benchmark_parse_mode("Escaped unicode (heap)", escaped_unicode, ParseMode_Heap);
+	benchmark_parse_mode("Escaped unicode (in situ+arena)", escaped_unicode, ParseMode_InSitu);
+
+	string small_nested = make_nested_document(SMALL_RECORD_COUNT);
+	benchmark_simd_levels("Minified nested", small_nested);
+	benchmark_simd_levels("Indented nested", JSON::Parse(small_nested).Stringify(true));
+	benchmark_simd_levels("Long strings", make_long_strings_document(SMALL_RECORD_COUNT));
+
+	benchmark_object_lookup(5);
+	for (int key_count = 10; key_count <= 100000; key_count *= 10)
+		benchmark_object_lookup(key_count);
+
+	print_out(vert_sep.c_str());
+}
@@ -128,10 +128,10 @@ void example2()
     srand((unsigned)time(0));
     for (int i = 0; i < 10; i++)
         array.push_back(JSONValue((double)(rand() % 100)));
-    root["sample_array"] = JSONValue(array);
+    root["sample_array"] = JSONValue(std::move(array));
 
-    // Create a value
-    JSONValue value = JSONValue(root);
+    // Create a value, moving the object in rather than copying it
+    JSONValue value = JSONValue(std::move(root));
 
     // Print it
     print_out(value.Stringify().c_str());
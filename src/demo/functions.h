@@ -1,5 +1,7 @@
 // The functions available, 1 single header to make things easier
 
+#include <cstddef>
+
 // The print out function
 void print_out(const char *output);
 
@@ -12,3 +14,11 @@ void example5();
 
 // Test case runner
 void run_tests();
+
+// Benchmark runner
+void run_benchmarks();
+
+// Reads the heap allocations made so far. Only set when allocation-count.cpp
+// is linked in, as it is for JSONBenchmark, so allocations aren't counted
+// by JSONDemo.
+extern void (*read_allocation_counts)(std::size_t &count, std::size_t &bytes);
@@ -25,6 +25,7 @@
 #include <string>
 #include <iostream>
 #include <iterator>
+#include <sstream>
 
 #include "../JSON.h"
 #include "functions.h"
@@ -92,6 +93,35 @@ int main(int argc, char **argv)
         cout << endl;
     }
 
+    // Parse + echo each line?
+    else if (mode == "-l")
+    {
+        // Get the stdin data
+        ostringstream input;
+        input << cin.rdbuf();
+
+        // Lines are echoed in order while the rest are still being parsed
+        string output;
+        try
+        {
+            JSON::ParseLines(input.str(), [&output](size_t, JSONValue &&value)
+            {
+                output += value.Stringify();
+                output += '\n';
+                if (output.size() >= 65536)
+                {
+                    cout << output;
+                    output.clear();
+                }
+            });
+            cout << output;
+        }
+        catch (const JSONException &e)
+        {
+            cout << output << e.what() << endl;
+        }
+    }
+
     // Example ?
     else if (mode == "-ex1")
     {
@@ -120,6 +150,12 @@ int main(int argc, char **argv)
         run_tests();
     }
 
+    // Benchmarks?
+    else if (mode == "-b")
+    {
+        run_benchmarks();
+    }
+
     // Help!
     else
     {
@@ -129,12 +165,14 @@ int main(int argc, char **argv)
         cout << "\t-f\tVerify JSON string is *invalid* via stdin" << endl;
         cout << "\t-e\tVerify JSON string via stdin and echo it back using Stringify()" << endl;
         cout << "\t-p\tVerify JSON string via stdin and prettyprint it using Stringify(true)" << endl;
+        cout << "\t-l\tVerify JSON Lines via stdin, one document per line, and echo each back using Stringify()" << endl;
         cout << "\t-ex1\tRun example 1 - Example of how to extract data from the JSONValue object" << endl;
         cout << "\t-ex2\tRun example 2 - Building a JSONValue from nothing" << endl;
         cout << "\t-ex3\tRun example 3 - Compact vs. prettyprint" << endl;
         cout << "\t-ex4\tRun example 4 - Example of fetching the keys in an object" << endl;
         cout << "\t-ex5\tRun example 5 - Read unescaped unicode character" << endl;
         cout << "\t-t\tRun test cases" << endl;
+        cout << "\t-b\tRun benchmarks (JSONBenchmark runs them counting allocations too)" << endl;
         cout << endl;
 		cout << "Only one option can be used at a time." << endl;
 	}
@@ -31,7 +31,15 @@
 #include <fstream>
 #include <iostream>
 #include <iomanip>
+#include <random>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
 #include "../JSON.h"
+#include "../JSONFlatMap.h"
+#include "../JSONReader.h"
+#include "../JSONIncrementalParser.h"
+#include "../JSONSimd.h"
 #include "functions.h"
 
 // Set to the width of the description column
@@ -57,6 +65,51 @@ bool parse_check(string str)
     return true;
 }
 
+// Helper to do a quick in situ parse check
+bool parse_check_in_situ(string str)
+{
+    try
+    {
+        JSONValue v = JSON::ParseInSitu(&str[0], str.size());
+    }
+    catch (const JSONException &e)
+    {
+        return false;
+    }
+
+    return true;
+}
+
+// Helper to do a quick parse check of the first 'length' characters
+bool parse_check_length(const char *data, size_t length)
+{
+    try
+    {
+        JSONValue v = JSON::Parse(data, length);
+    }
+    catch (const JSONException &e)
+    {
+        return false;
+    }
+
+    return true;
+}
+
+// Helper to do a quick parse check with the structural index
+bool parse_check_indexed(string str)
+{
+    try
+    {
+        JSONValue v = JSON::Parse(str.data(), str.size(), JSONParse_Indexed);
+    }
+    catch (const JSONException &e)
+    {
+        return false;
+    }
+
+    return true;
+}
+
 // Helper to get a files contents
 bool get_file(string filename, string &description, string &data)
 {
@@ -78,6 +131,37 @@ bool get_file(string filename, string &description, string &data)
 	return true;
 }
 
+// Handler that writes out each event it's given, stopping at a key if asked
+class RecordingHandler : public JSONHandler
+{
+	public:
+		RecordingHandler(string stop = "") : stop_key(stop) {}
+
+		bool Null() { events += "null "; return true; }
+		bool Bool(bool value) { events += value ? "true " : "false "; return true; }
+		bool Number(double value) { events += "n:" + JSONValue(value).Stringify() + " "; return true; }
+		bool Integer(int64_t value) { events += "i:" + to_string(value) + " "; return true; }
+		bool Unsigned(uint64_t value) { events += "u:" + to_string(value) + " "; return true; }
+		bool String(string_view value) { events += "s:" + string(value) + " "; return true; }
+		bool StartObject() { events += "{ "; return true; }
+		bool Key(string_view name) { events += "k:" + string(name) + " "; return name != stop_key; }
+		bool EndObject() { events += "} "; return true; }
+		bool StartArray() { events += "[ "; return true; }
+		bool EndArray() { events += "] "; return true; }
+
+		string stop_key;
+		string events;
+};
+
+// Helper to print the result row of a single static test
+void print_test_result(string description, bool passed)
+{
+	ostringstream stream;
+	stream.setf(ios_base::left, ios_base::adjustfield);
+	stream << "| " << setw(DESC_LENGTH) << description << " | " << (passed ? "passed" : "failed") << " |\r\n";
+	print_out(stream.str().c_str());
+}
+
 // Run a pass / fail test
 void run_test_type(bool type)
 {
@@ -223,5 +307,630 @@ void run_tests()
 	}
 	print_out(test_output.c_str());
 
+	// Assigning a value one of its own children must not read freed data
+	JSONValue nested = JSON::Parse("[[\"inner\", 1], 2]");
+	nested = nested.Child(0);
+	print_test_result("Testing JSONValue assignment from own child",
+		nested.Stringify() == "[\"inner\",1]");
+
+	// Accessors on the wrong type fall back to empty values
+	JSONValue number_value(1.5);
+	print_test_result("Testing JSONValue accessors on wrong type",
+		number_value.AsString().empty() && number_value.AsArray().empty() &&
+		number_value.AsObject().empty() && !number_value.HasChild(0) &&
+		!number_value.HasChild("key"));
+
+	// Moving a value hands over the payload and leaves the source NULL
+	JSONArray move_array;
+	move_array.push_back(JSONValue("moved"));
+	JSONValue move_source(std::move(move_array));
+	JSONValue move_target(std::move(move_source));
+	print_test_result("Testing JSONValue move construction",
+		move_source.IsNull() && move_target.Stringify() == "[\"moved\"]");
+
+	// Parsing into an arena gives the same tree as parsing onto the heap
+	JSONArena arena;
+	JSONValue detached;
+	{
+		JSONValue arena_value = JSON::Parse(EXAMPLE, arena);
+		bool borrowed_throws = false;
+		try
+		{
+			arena_value.Child("sub_object").Child("foo").AsString();
+		}
+		catch (const JSONException &e)
+		{
+			borrowed_throws = true;
+		}
+		print_test_result("Testing parse into an arena",
+			arena_value.Stringify() == json_check && arena_value.Child("sub_object").Child("foo").AsStringView() == "abc" &&
+			borrowed_throws);
+		detached = arena_value;
+	}
+	arena.Reset();
+	JSONValue reused = JSON::Parse("[\"reused arena\", {\"key\": \"value\"}]", arena);
+	print_test_result("Testing arena reuse after Reset()",
+		reused.Stringify() == "[\"reused arena\",{\"key\":\"value\"}]" && detached.Stringify() == json_check &&
+		detached.Child("sub_object").Child("foo").AsString() == "abc");
+
+	// Unescaped strings refer into the parsed text, escaped ones are copied
+	const char *view_text = "{\"plain\": \"no escapes\", \"escaped\": \"tab\\there\"}";
+	JSONValue view_value = JSON::ParseView(view_text);
+	std::string_view plain = view_value.Child("plain").AsStringView();
+	print_test_result("Testing zero-copy string parsing",
+		plain == "no escapes" && plain.data() > view_text && plain.data() < view_text + strlen(view_text) &&
+		view_value.Child("escaped").AsString() == "tab\there" && view_value.Stringify() == JSON::Parse(view_text).Stringify());
+
+	// In situ parsing unescapes strings over the text they came from
+	string in_situ_text = "[\"plain\", \"line\\nbreak \\u00BE\", {\"key\": \"\\\"quoted\\\"\"}]";
+	string in_situ_check = JSON::Parse(in_situ_text).Stringify();
+	JSONValue in_situ_value = JSON::ParseInSitu(&in_situ_text[0], in_situ_text.size());
+	std::string_view unescaped = in_situ_value.Child(1).AsStringView();
+	print_test_result("Testing in situ string parsing",
+		unescaped == "line\nbreak \u00BE" && unescaped.data() >= in_situ_text.data() &&
+		unescaped.data() < in_situ_text.data() + in_situ_text.size() && in_situ_value.Stringify() == in_situ_check);
+
+	string embedded_null("[1]\0[2]", 7);
+	print_test_result("Testing in situ parsing rejects embedded NULLs",
+		!parse_check_in_situ(embedded_null));
+
+	// Length delimited text is parsed up to its end and no further, so it
+	// can be a slice of a larger buffer, with each SIMD level
+	bool slice_ok = true;
+	bool slice_nulls_ok = true;
+	JSONSimdLevel slice_level = simplejson_simd_level();
+	for (int level = JSONSimd_Scalar; level <= JSONSimd_AVX2; level++)
+	{
+		simplejson_set_simd_level((JSONSimdLevel)level);
+		const char *slices = "[1,2][true,null,\"x\",12345678901]garbage";
+		slice_ok = slice_ok && JSON::Parse(slices, 5).Stringify() == "[1,2]" &&
+			JSON::Parse(slices + 5, 27).Stringify() == "[true,null,\"x\",12345678901]" &&
+			JSON::Parse("truex", 4).AsBool() && JSON::Parse("12345678901234", 9).AsInt64() == 123456789 &&
+			JSON::Parse(" 2.5e10 ", 6).AsNumber() == 2.5e1 && !parse_check_length("null", 3) &&
+			!parse_check_length("\"ab\"", 3) && !parse_check_length("[1,2]", 4) && !parse_check_length("", 0);
+
+		slice_nulls_ok = slice_nulls_ok && !parse_check_length("[1]\0x", 5) && !parse_check_length("[\"a\0b\"]", 7) &&
+			!parse_check_length("{\"a\0\":1}", 9) && parse_check_length("[1]\0x", 3);
+	}
+	simplejson_set_simd_level(slice_level);
+	print_test_result("Testing length delimited parsing", slice_ok);
+	try
+	{
+		JSON::Parse(string("[1]\0", 4));
+		slice_nulls_ok = false;
+	}
+	catch (const JSONException &e)
+	{
+	}
+	print_test_result("Testing embedded NULLs are rejected", slice_nulls_ok);
+
+	// Runs of whitespace of every length parse the same with each SIMD level
+	bool whitespace_ok = true;
+	JSONSimdLevel simd_level = simplejson_simd_level();
+	for (int level = JSONSimd_Scalar; level <= JSONSimd_AVX2; level++)
+	{
+		simplejson_set_simd_level((JSONSimdLevel)level);
+		for (size_t length = 0; length < 70; length++)
+		{
+			string padding;
+			for (size_t i = 0; i < length; i++)
+				padding += " \t\r\n"[i % 4];
+			whitespace_ok = whitespace_ok &&
+				parse_check(padding + "[" + padding + "1" + padding + "," + padding + "{}" + padding + "]" + padding) &&
+				!parse_check(padding + "[" + padding + "1" + padding + "," + padding + "x]" + padding) &&
+				parse_check_indexed(padding + "[" + padding + "1" + padding + "," + padding + "{}" + padding + "]" + padding) &&
+				!parse_check_indexed(padding + "[" + padding + "1" + padding + "," + padding + "x]" + padding);
+		}
+	}
+	simplejson_set_simd_level(simd_level);
+	print_test_result("Testing whitespace skipping at each SIMD level", whitespace_ok);
+
+	// Strings of every length, with an escape or control character at every
+	// position, give the same value with each SIMD level
+	bool strings_ok = true;
+	for (int level = JSONSimd_Scalar; level <= JSONSimd_AVX2; level++)
+	{
+		simplejson_set_simd_level((JSONSimdLevel)level);
+		for (size_t length = 0; length < 70; length++)
+		{
+			string plain;
+			for (size_t i = 0; i < length; i++)
+				plain += "abc\xC3\xA9xyz"[i % 8];
+			string quoted = "\"" + plain + "\"";
+			strings_ok = strings_ok && JSON::Parse(quoted).AsString() == plain &&
+				JSON::ParseView(quoted.c_str(), JSONParse_Indexed).AsStringView() == plain;
+
+			for (size_t pos = 0; pos <= length; pos++)
+			{
+				string escaped = "\"" + plain.substr(0, pos) + "\\\"" + plain.substr(pos) + "\"";
+				string control = "\"" + plain.substr(0, pos) + "\t" + plain.substr(pos) + "\"";
+				strings_ok = strings_ok &&
+					JSON::Parse(escaped).AsString() == plain.substr(0, pos) + "\"" + plain.substr(pos) &&
+					JSON::ParseView(control.c_str(), JSONParse_Indexed).AsStringView() == plain.substr(0, pos) + "\t" + plain.substr(pos) &&
+					!parse_check("\"" + plain.substr(0, pos));
+			}
+		}
+	}
+	simplejson_set_simd_level(simd_level);
+	print_test_result("Testing string scanning at each SIMD level", strings_ok);
+
+	// Strings of every length, with a character to escape at every position,
+	// are written the same and read back unchanged with each SIMD level
+	bool escaping_ok = true;
+	for (int level = JSONSimd_Scalar; level <= JSONSimd_AVX2; level++)
+	{
+		simplejson_set_simd_level((JSONSimdLevel)level);
+		for (size_t length = 0; length < 70; length++)
+		{
+			string plain;
+			for (size_t i = 0; i < length; i++)
+				plain += "ab/c\xC3\xA9xyz"[i % 8];
+			escaping_ok = escaping_ok && JSONValue(plain).Stringify() == "\"" + plain + "\"";
+
+			for (size_t pos = 0; pos <= length; pos++)
+			{
+				string special = plain.substr(0, pos) + "\"\x01\n" + plain.substr(pos);
+				string expected = "\"" + plain.substr(0, pos) + "\\\"\\u0001\\n" + plain.substr(pos) + "\"";
+				escaping_ok = escaping_ok && JSONValue(special).Stringify() == expected &&
+					JSON::Parse(expected).AsString() == special;
+			}
+		}
+	}
+	simplejson_set_simd_level(simd_level);
+	string all_controls;
+	for (int chr = 0; chr < 0x20; chr++)
+		all_controls += (char)chr;
+	print_test_result("Testing string escaping at each SIMD level", escaping_ok &&
+		JSON::Parse(JSONValue(all_controls).Stringify()).AsString() == all_controls &&
+		JSONValue(string("\x1F\b\f\r\t\\", 6)).Stringify() == "\"\\u001F\\b\\f\\r\\t\\\\\"");
+
+	// The structural index parses the same as the recursive parser, with
+	// escapes and strings across its 64 character blocks and its batches
+	string index_document = "[";
+	for (int i = 0; i < 400; i++)
+	{
+		if (i) index_document += ",";
+		index_document += "{\"k" + string(i % 70, 'x') + (i % 2 ? "\\\\" : "\\\"") + "\":";
+		const char *values[] = { "-12.5e1", "TRUE", "null", "\"s\\\\\\\"\"", "[1, {}]", "\"\\u00e9\"" };
+		index_document += string(i % 5, ' ') + values[i % 6] + "}";
+	}
+	index_document += "]";
+	string index_cases[] = { EXAMPLE, index_document, "{\"a\\\\\":[1,\"\\\"\",true,{\"b\":null}],\"c\":-2.5e3}" };
+	vector<string> index_docs(index_cases, index_cases + 3);
+	for (size_t pos = 0; pos < index_cases[2].size(); pos++)
+	{
+		for (const char *chr = "\"\\ ,:]}x1"; *chr; chr++)
+		{
+			index_docs.push_back(index_cases[2]);
+			index_docs.back()[pos] = *chr;
+		}
+	}
+	vector<string> index_expected;
+	simplejson_set_simd_level(JSONSimd_Scalar);
+	for (size_t i = 0; i < index_docs.size(); i++)
+		index_expected.push_back(parse_check(index_docs[i]) ? JSON::Parse(index_docs[i]).Stringify() : "invalid");
+	bool index_ok = index_expected[1] != "invalid";
+	for (int level = JSONSimd_SSE2; level <= JSONSimd_AVX2; level++)
+	{
+		simplejson_set_simd_level((JSONSimdLevel)level);
+		for (size_t i = 0; i < index_docs.size(); i++)
+			index_ok = index_ok && (parse_check_indexed(index_docs[i]) ?
+				JSON::Parse(index_docs[i].data(), index_docs[i].size(), JSONParse_Indexed).Stringify() : "invalid") == index_expected[i];
+		index_ok = index_ok && !parse_check_indexed("{:\"a\":1}") && !parse_check_indexed("[truex]") &&
+			!parse_check_indexed("[1.5.2]") && !parse_check_indexed("[1 2]");
+	}
+	simplejson_set_simd_level(simd_level);
+	print_test_result("Testing the structural index at each SIMD level", index_ok);
+
+	print_test_result("Testing \\u escapes decode to UTF-8",
+		JSON::Parse("\"a\\u00e9\\u20AC\\uD83D\\uDE00\\u0041\"").AsString() == "a\u00e9\u20AC\U0001F600A" &&
+		parse_check_in_situ("\"\\uD83D\\uDE00 \\u00e9\""));
+	print_test_result("Testing lone surrogates are not valid",
+		!parse_check("\"\\uD83D\"") && !parse_check("\"\\uDE00\"") && !parse_check("\"\\uD83Dx\"") &&
+		!parse_check("\"\\uD83D\\u0041\"") && !parse_check("\"\\uD83D\\uD83D\"") && !parse_check("\"\\u12\""));
+
+	// Numbers must come out bit for bit the same as strtod() gives, both
+	// short ones and those needing the slow path
+	const char *hard_numbers[] = {
+		"0", "-0", "1", "0.1", "0.3", "1e23", "8.98846567431158e307", "1.7976931348623157e308",
+		"1.7976931348623159e308", "4.9e-324", "2.4703282292062327e-324", "2.2250738585072011e-308",
+		"9007199254740993", "9007199254740992.000000000000000000001", "123456789012345678901234567890",
+		"0.000000000000000000000000000001234", "1e-400", "-1e400", "7.038531e-26", "1E+2", "2e0003",
+		"9007199254740993e-22", "1.00000000000000011102230246251565404236316680908203125", "4503599627370496.5",
+		"2.2250738585072012e-308", "1.9156918820264798e-56", "6.6564021122018745e+264"
+	};
+	bool numbers_ok = true;
+	std::mt19937_64 random(12345);
+	for (int i = 0; i < 40000 + (int)(sizeof(hard_numbers) / sizeof(hard_numbers[0])); i++)
+	{
+		char text[64];
+		if (i < (int)(sizeof(hard_numbers) / sizeof(hard_numbers[0])))
+			snprintf(text, sizeof(text), "%s", hard_numbers[i]);
+		else if (i % 2)
+		{
+			std::uint64_t bits = random();
+			double value;
+			memcpy(&value, &bits, sizeof(value));
+			if (value != value || value - value != 0)
+				continue;
+			snprintf(text, sizeof(text), "%.*g", (int)(random() % 17) + 1, value);
+		}
+		else if (i % 4)
+			snprintf(text, sizeof(text), "%llu.%llue%d", (unsigned long long)(random() % 100000000000ull),
+				(unsigned long long)random(), (int)(random() % 80) - 40);
+		else
+			snprintf(text, sizeof(text), "%llue%d", (unsigned long long)(random() % 10000000000000000000ull),
+				(int)(random() % 680) - 360);
+
+		double expected = strtod(text, 0);
+		double parsed = JSON::Parse(text).AsNumber();
+		numbers_ok = numbers_ok && memcmp(&expected, &parsed, sizeof(double)) == 0;
+	}
+	print_test_result("Testing numbers parse the same as strtod()", numbers_ok);
+	print_test_result("Testing invalid numbers are not valid",
+		!parse_check("01") && !parse_check("-") && !parse_check("1.") && !parse_check(".5") &&
+		!parse_check("1e") && !parse_check("1e+") && !parse_check("-x") && !parse_check("+1"));
+
+	string integers = "[0,-1,9007199254740993,9223372036854775807,-9223372036854775808,18446744073709551615]";
+	JSONValue integer_values = JSON::Parse(integers);
+	bool integers_ok = integer_values.Stringify() == integers;
+	for (size_t i = 0; i < integer_values.CountChildren(); i++)
+		integers_ok = integers_ok && integer_values.Child(i).IsInteger() && integer_values.Child(i).IsNumber();
+	print_test_result("Testing 64 bit integers are kept exact",
+		integers_ok && integer_values.Child(2).AsInt64() == 9007199254740993LL &&
+		integer_values.Child(4).AsInt64() == INT64_MIN && integer_values.Child(5).AsUInt64() == UINT64_MAX &&
+		integer_values.Child(5).AsInt64() == INT64_MAX && integer_values.Child(1).AsUInt64() == 0 &&
+		integer_values.Child(2).AsNumber() == 9007199254740992.0 && JSONValue(5).IsInteger());
+
+	JSONValue not_integers = JSON::Parse("[1.0,1e2,-0,18446744073709551616,-9223372036854775809,1.5e300,-2.5]");
+	bool not_integers_ok = true;
+	for (size_t i = 0; i < not_integers.CountChildren(); i++)
+		not_integers_ok = not_integers_ok && !not_integers.Child(i).IsInteger() && not_integers.Child(i).IsNumber();
+	print_test_result("Testing fractions and big numbers are doubles",
+		not_integers_ok && not_integers.Child(1).AsInt64() == 100 && not_integers.Child(5).AsInt64() == INT64_MAX &&
+		not_integers.Child(6).AsInt64() == -2 && not_integers.Child(6).AsUInt64() == 0 &&
+		not_integers.Child(3).AsUInt64() == UINT64_MAX);
+
+	// Doubles are written with as few digits as parse back to the same bits
+	bool round_trip_ok = true;
+	std::mt19937_64 double_bits(12345);
+	for (int i = 0; i < 20000 && round_trip_ok; i++)
+	{
+		uint64_t bits = double_bits();
+		double original;
+		memcpy(&original, &bits, sizeof(original));
+		if (isnan(original) || isinf(original))
+			continue;
+
+		double parsed = JSON::Parse(JSONValue(original).Stringify()).AsNumber();
+		round_trip_ok = memcmp(&original, &parsed, sizeof(double)) == 0;
+	}
+	print_test_result("Testing doubles round trip through Stringify()",
+		round_trip_ok && JSONValue(0.1).Stringify() == "0.1" && JSONValue(100.0).Stringify() == "100" &&
+		JSONValue(-0.0).Stringify() == "-0" && JSONValue(1e300).Stringify() == "1e+300" &&
+		JSONValue(0.1 + 0.2).Stringify() == "0.30000000000000004" && JSONValue(-1234567.0).Stringify() == "-1234567" &&
+		JSONValue(5e-324).Stringify() == "5e-324" && JSONValue(1e16).Stringify() == "1e+16");
+
+	// A document bigger than WriteTo()'s buffer, with a string bigger than it too
+	JSONArray write_array;
+	for (int i = 0; i < 5000; i++)
+		write_array.push_back(JSON::Parse("{\"id\":" + to_string(i) + ",\"name\":\"item\\n" + to_string(i) + "\",\"on\":true}"));
+	write_array.push_back(JSONValue(string(100000, 'x')));
+	JSONValue write_value(write_array);
+	bool write_ok = true;
+	for (int pretty = 0; pretty < 2; pretty++)
+	{
+		string expected = write_value.Stringify(pretty != 0);
+		ostringstream stream;
+		write_ok = write_ok && write_value.WriteTo(stream, pretty != 0) && stream.str() == expected;
+
+		FILE *file = tmpfile();
+		write_ok = write_ok && file != 0 && write_value.WriteTo(file, pretty != 0);
+		if (file != 0)
+		{
+#ifndef _WIN32
+			fflush(file);
+			write_ok = write_ok && write_value.WriteTo(fileno(file), pretty != 0) && !write_value.WriteTo(-1);
+			expected += expected;
+#endif
+			rewind(file);
+			string written(expected.size() + 1, 0);
+			written.resize(fread(&written[0], 1, written.size(), file));
+			write_ok = write_ok && written == expected;
+			fclose(file);
+		}
+	}
+	print_test_result("Testing WriteTo() streams, FILE*s and fds", write_ok);
+
+	// Lazy numbers are written back out exactly as they were parsed
+	string lazy_text = "[1.0,1E+2,-0,0.1e-5,18446744073709551615,123456789012345678901234567890,12]";
+	JSONValue lazy_value = JSON::ParseView(lazy_text.c_str(), JSONParse_LazyNumbers);
+	JSONValue lazy_copy = lazy_value;
+	print_test_result("Testing lazy numbers",
+		lazy_value.Stringify() == lazy_text && lazy_value.Child(1).AsNumber() == 100.0 &&
+		lazy_value.Child(4).IsInteger() && lazy_value.Child(4).AsUInt64() == UINT64_MAX &&
+		!lazy_value.Child(5).IsInteger() && lazy_value.Child(6).AsInt64() == 12 &&
+		lazy_value.Stringify() == lazy_text && lazy_copy.Child(0).Stringify() == "1" &&
+		lazy_copy.Child(6).IsInteger() && lazy_copy.Stringify() == JSON::Parse(lazy_text).Stringify());
+
+	bool lazy_invalid_ok = true;
+	const char *lazy_invalid[] = { "[01]", "[1.]", "[-]", "[1e]", "[.5]", "[1e+]" };
+	for (size_t i = 0; i < sizeof(lazy_invalid) / sizeof(lazy_invalid[0]); i++)
+	{
+		try
+		{
+			JSON::ParseView(lazy_invalid[i], JSONParse_LazyNumbers);
+			lazy_invalid_ok = false;
+		}
+		catch (const JSONException &e)
+		{
+		}
+	}
+	print_test_result("Testing lazy numbers are still checked", lazy_invalid_ok);
+
+	string lookup_text = "{\"alpha\":1,\"beta\":[true],\"gamma\":{\"delta\":\"x\"}}";
+	JSONValue lookup_value = JSON::Parse(lookup_text);
+	string_view beta_key = string_view("beta and more").substr(0, 4);
+	print_test_result("Testing object lookups without a std::string",
+		lookup_value.HasChild("alpha") && lookup_value.Child(beta_key).Child(0).AsBool() &&
+		lookup_value.Child("gamma").Child("delta").AsString() == "x" && !lookup_value.HasChild(string_view("alphabet", 3)) &&
+		!lookup_value.HasChild("") && lookup_value.CountChildren() == 3);
+
+#ifndef SIMPLEJSON_SORTED_OBJECTS
+	string ordered_text = "{\"zeta\":1,\"alpha\":2,\"mu\":{\"b\":3,\"a\":4},\"beta\":5}";
+	JSONValue ordered_value = JSON::Parse(ordered_text);
+	vector<string> ordered_keys = ordered_value.ObjectKeys();
+	JSONObject ordered_object = ordered_value.AsObject();
+	ordered_object["omega"] = JSONValue(6);
+	print_test_result("Testing objects keep their key order",
+		ordered_value.Stringify() == ordered_text && ordered_keys.size() == 4 && ordered_keys[0] == "zeta" &&
+		ordered_keys[3] == "beta" && (--ordered_object.end())->first == "omega" &&
+		JSON::Parse(ordered_value.Stringify(true)).Stringify() == ordered_text);
+#endif
+
+	// Both documents should share the pool's copy of each key
+	JSONKeyPool key_pool;
+	string interned_text = "{\"a_rather_long_key_name\":1,\"short\":{\"a_rather_long_key_name\":2}}";
+	JSONValue interned_first = JSON::Parse(interned_text, key_pool);
+	JSONValue interned_second = JSON::Parse(interned_text, key_pool);
+	const JSONKey &first_key = interned_first.AsObject().begin()->first;
+	const JSONKey &second_key = interned_second.AsObject().begin()->first;
+	JSONKey long_key = key_pool.Intern("a_rather_long_key_name");
+	JSONKey copied_key = long_key;
+	bool interned_ok = interned_first.Stringify() == interned_text;
+#ifndef SIMPLEJSON_SORTED_OBJECTS
+	interned_ok = interned_ok && key_pool.Size() == 2 && first_key.IsInterned() && first_key.data() == second_key.data() &&
+		first_key.data() == long_key.data() && copied_key == long_key && long_key == JSONKey("a_rather_long_key_name") &&
+		interned_first.AsObject().find(long_key)->second.AsInt64() == 1 &&
+		interned_second.Child("short").AsObject().count(long_key) == 1 &&
+		!JSON::Parse(interned_text).AsObject().begin()->first.IsInterned();
+#endif
+	JSONKey inline_key("fourteen chars"), heap_key("fifteen chars!!");
+	print_test_result("Testing interned object keys", interned_ok && sizeof(JSONKey) == 16 &&
+		inline_key.size() == 14 && strcmp(heap_key.c_str(), "fifteen chars!!") == 0 && heap_key != inline_key &&
+		key_pool.Intern("short") != long_key && JSONKey().empty());
+
+	// Keys still work where std::string keys did
+	string key_string = heap_key;
+	const string &key_reference = heap_key;
+	print_test_result("Testing keys convert and compare as strings",
+		key_string == "fifteen chars!!" && key_reference == key_string && heap_key == key_string &&
+		key_string == heap_key && heap_key == string_view("fifteen chars!!") && heap_key == "fifteen chars!!" &&
+		heap_key != "fourteen chars" && heap_key < inline_key && !(inline_key < "fifteen") && "a" < heap_key);
+
+	// JSONFlatMap is checked directly so it's covered whichever JSONObject is built
+	JSONArena flat_arena;
+	JSONFlatMap<JSONValue, JSONAllocator<pair<JSONKey, JSONValue> > > flat_map(&flat_arena);
+	for (int i = 0; i < 1000; i++)
+		flat_map["key" + to_string(i)] = JSONValue(i);
+	bool flat_ok = flat_map.size() == 1000 && flat_map.begin()->first == "key0";
+	for (int i = 0; i < 1000; i += 2)
+		flat_ok = flat_ok && flat_map.erase("key" + to_string(i)) == 1;
+	JSONFlatMap<JSONValue, JSONAllocator<pair<JSONKey, JSONValue> > > flat_copy = flat_map;
+	for (int i = 0; i < 1000; i++)
+	{
+		bool expected = i % 2 == 1;
+		string key = "key" + to_string(i);
+		flat_ok = flat_ok && (flat_map.count(key) == 1) == expected && (flat_copy.count(key) == 1) == expected;
+		flat_ok = flat_ok && (!expected || flat_copy.at(key).AsInt64() == i);
+	}
+	flat_ok = flat_ok && !flat_map.insert(make_pair(string("key1"), JSONValue(0))).second && flat_map["key1"].AsInt64() == 1;
+	JSONFlatMap<int> small_map;
+	for (int i = 0; i < 8; i++)
+		small_map["small" + to_string(i)] = i;
+	small_map.erase("small3");
+	flat_ok = flat_ok && small_map.size() == 7 && small_map.count("small3") == 0 && small_map.at("small7") == 7 &&
+		(small_map.begin() + 3)->first == "small4";
+	small_map["small8"] = 8;
+	small_map["small9"] = 9;
+	flat_ok = flat_ok && small_map.at("small9") == 9 && small_map.at("small0") == 0 && small_map.size() == 9;
+	flat_map.clear();
+	print_test_result("Testing JSONFlatMap", flat_ok && flat_map.empty() && flat_map.find("key1") == flat_map.end() &&
+		flat_copy.size() == 500 && flat_map.get_allocator().arena == &flat_arena && flat_copy.get_allocator().arena == 0);
+
+	RecordingHandler recorder;
+	bool events_ok = JSON::ParseEvents(" {\"a\":[1,-2.5,true,null,\"x\\ty\"],\"b\\u0041\":{},\"c\":18446744073709551615,\"d\":[]} ", recorder) &&
+		recorder.events == "{ k:a [ i:1 n:-2.5 true null s:x\ty ] k:bA { } k:c u:18446744073709551615 k:d [ ] } ";
+	RecordingHandler stopper("b");
+	events_ok = events_ok && !JSON::ParseEvents("{\"a\":1,\"b\":2,\"c\":3}", stopper) && stopper.events == "{ k:a i:1 k:b ";
+	const char *events_invalid[] = { "", " ", "[1,]", "{\"a\" 1}", "[1] 2", "[\"abc]", "{\"a\":1", "tru", "[01]" };
+	for (size_t i = 0; i < sizeof(events_invalid) / sizeof(events_invalid[0]); i++)
+	{
+		RecordingHandler ignored;
+		events_ok = events_ok && !JSON::ParseEvents(events_invalid[i], ignored);
+	}
+	// A slice stops at its length, where a NULL inside it is invalid
+	RecordingHandler slice_recorder, null_handler;
+	events_ok = events_ok && JSON::ParseEvents("[1,2]]", 5, slice_recorder) && slice_recorder.events == "[ i:1 i:2 ] " &&
+		!JSON::ParseEvents("[\"a\0b\"]", 7, null_handler) && !JSON::ParseEvents("[1,\0 2]", 7, null_handler);
+	JSONHandler default_handler;
+	print_test_result("Testing ParseEvents() handlers", events_ok && JSON::ParseEvents(EXAMPLE, default_handler));
+
+	// Only the ids are read, everything else is skipped whole
+	JSONReader reader(" [{\"skip\":{\"a\":[1,{}]},\"id\":-3,\"name\":\"x\\ny\"},{\"id\":18446744073709551615,\"on\":true},[],null] ");
+	bool reader_ok = reader.Next() && reader.TokenType() == JSONToken_StartArray && reader.Depth() == 1;
+	reader_ok = reader_ok && reader.Next() && reader.TokenType() == JSONToken_StartObject && reader.Next() &&
+		reader.TokenType() == JSONToken_Key && reader.GetString() == "skip" && reader.SkipValue() &&
+		reader.TokenType() == JSONToken_EndObject && reader.Depth() == 2;
+	reader_ok = reader_ok && reader.Next() && reader.GetString() == "id" && reader.Next() &&
+		reader.TokenType() == JSONToken_Number && reader.IsInteger() && reader.GetInt64() == -3;
+	reader_ok = reader_ok && reader.Next() && reader.Next() && reader.TokenType() == JSONToken_String && reader.GetString() == "x\ny" &&
+		reader.Next() && reader.TokenType() == JSONToken_EndObject;
+	reader_ok = reader_ok && reader.Next() && reader.Next() && reader.Next() && reader.GetUInt64() == UINT64_MAX &&
+		reader.Next() && reader.GetString() == "on" && reader.Next() && reader.TokenType() == JSONToken_Bool && reader.GetBool() &&
+		reader.Next() && reader.TokenType() == JSONToken_EndObject;
+	reader_ok = reader_ok && reader.Next() && reader.SkipValue() && reader.TokenType() == JSONToken_EndArray &&
+		reader.Next() && reader.TokenType() == JSONToken_Null && reader.Next() && reader.TokenType() == JSONToken_EndArray &&
+		reader.Depth() == 0 && !reader.Next() && reader.TokenType() == JSONToken_End && !reader.HasError();
+	JSONReader skipper("{\"a\":[\"\\\"]\\ud83d\\ude00\",{\"b\\n\":-1.5e3},TRUE,null,[]],\"z\":0}");
+	reader_ok = reader_ok && skipper.Next() && skipper.SkipValue() && skipper.TokenType() == JSONToken_EndObject && skipper.Depth() == 0 &&
+		!skipper.Next() && !skipper.HasError();
+	const char *reader_invalid[] = { "", "[1,]", "{\"a\" 1}", "[1] 2", "{\"a\":1", "[{\"a\":[1 2]}]", "{1:2}", "[1.]",
+		"[[1,]]", "[{\"a\":1,}]", "[{\"a\"}]", "[[1:2]]", "[[tru]]", "[[01]]", "[[\"\\x\"]]", "[[\"\\ud800\"]]", "[[\"abc]]", "[[}]", "[{]}" };
+	for (size_t i = 0; i < sizeof(reader_invalid) / sizeof(reader_invalid[0]); i++)
+	{
+		JSONReader invalid(reader_invalid[i]);
+		while (invalid.Next())
+			invalid.SkipValue();
+		reader_ok = reader_ok && invalid.HasError();
+	}
+	JSONReader slice("[1]]", 3);
+	reader_ok = reader_ok && slice.Next() && slice.Next() && slice.GetInt64() == 1 && slice.Next() && !slice.Next() && !slice.HasError();
+	string reader_nulls[] = { string("[\"a\0b\"]", 7), string("[1,\0 2]", 7), string("[[\"a\0\"]]", 8) };
+	for (size_t i = 0; i < sizeof(reader_nulls) / sizeof(reader_nulls[0]); i++)
+	{
+		JSONReader invalid(reader_nulls[i].data(), reader_nulls[i].size());
+		while (invalid.Next())
+			invalid.SkipValue();
+		reader_ok = reader_ok && invalid.HasError();
+	}
+	print_test_result("Testing JSONReader", reader_ok);
+
+	// Every way of splitting the documents should give the same result
+	JSON::IncrementalParser incremental;
+	string incremental_docs[] = { EXAMPLE, " {\"k\\\"ey\":[\"a\\u00e9\\ud83d\\ude00\\n\",-12.5e-1,TRUE,null,{}],\"\":[[]],\"t\":\"tab\there\"} ",
+		"18446744073709551615", " -0.25 ", "false", "\"top\"" };
+	bool incremental_ok = true;
+	for (size_t i = 0; i < sizeof(incremental_docs) / sizeof(incremental_docs[0]); i++)
+	{
+		const string &doc = incremental_docs[i];
+		string expected = JSON::Parse(doc).Stringify();
+		for (size_t chunk = 1; chunk <= doc.size(); chunk += (chunk < 16 ? 1 : 97))
+		{
+			for (size_t offset = 0; offset < doc.size(); offset += chunk)
+				incremental_ok = incremental_ok && incremental.Feed(doc.data() + offset, min(chunk, doc.size() - offset));
+			incremental_ok = incremental_ok && incremental.Finish().Stringify() == expected;
+		}
+	}
+	const char *incremental_invalid[] = { "", " ", "[1,]", "{\"a\" 1}", "[1] 2", "{\"a\":1", "[\"abc", "tru", "[01]", "[1 2]", "{1:2}", "[1.]", "nul l",
+		"[\"\\x\"]", "[\"\\u12x4\"]", "[\"\\ude00\"]", "[\"\\ud83dx\"]", "[\"\\ud83d\\u0041\"]", "[\"a\\" };
+	for (size_t i = 0; i < sizeof(incremental_invalid) / sizeof(incremental_invalid[0]); i++)
+	{
+		for (size_t chunk = 1; chunk <= 2; chunk++)
+		{
+			size_t length = strlen(incremental_invalid[i]);
+			for (size_t offset = 0; offset < length; offset += chunk)
+				incremental.Feed(incremental_invalid[i] + offset, min(chunk, length - offset));
+			try
+			{
+				incremental.Finish();
+				incremental_ok = false;
+			}
+			catch (const JSONException &e)
+			{
+			}
+		}
+	}
+	incremental_ok = incremental_ok && incremental.Feed("[\"\\u1", 5) && !incremental.Feed("x", 1);
+	try
+	{
+		incremental.Finish();
+		incremental_ok = false;
+	}
+	catch (const JSONException &e)
+	{
+	}
+	incremental_ok = incremental_ok && !incremental.Feed("[1]]", 4) && incremental.HasError();
+	try
+	{
+		incremental.Finish();
+		incremental_ok = false;
+	}
+	catch (const JSONException &e)
+	{
+	}
+	print_test_result("Testing JSON::IncrementalParser", incremental_ok &&
+		incremental.Feed("{\"a\":", 5) && incremental.Feed("[1]}", 4) && incremental.Finish().Child("a").Child(0).AsInt64() == 1);
+
+	// Enough lines for several chunks, so the threads hand them back out of order
+	string lines_text;
+	for (int i = 0; i < 50000; i++)
+		lines_text += (i % 1000 == 0 ? "\r\n \n" : "") + string("{\"line\":") + to_string(i) + ",\"tags\":[\"a\",\"b\"]}\n";
+	vector<JSONValue> lines_values = JSON::ParseLines(lines_text, 4);
+	bool lines_ok = lines_values.size() == 50000 && JSON::ParseLines(lines_text, 1).size() == 50000 &&
+		JSON::ParseLines("").empty() && JSON::ParseLines("1\n[2]").size() == 2;
+	for (size_t i = 0; i < lines_values.size(); i++)
+		lines_ok = lines_ok && lines_values[i].Child("line").AsInt64() == static_cast<int64_t>(i);
+	size_t bad_offset = lines_text.size() - 100000;
+	size_t bad_line = count(lines_text.begin(), lines_text.begin() + bad_offset, '\n') + 1;
+	lines_text.insert(bad_offset, "{\"bad\"}\n");
+	for (unsigned int threads = 1; threads <= 4; threads += 3)
+	{
+		size_t lines_seen = 0, last_line = 0;
+		try
+		{
+			JSON::ParseLines(lines_text, [&](size_t line, JSONValue &&value)
+			{
+				lines_ok = lines_ok && line > last_line && value.Child("line").AsInt64() == static_cast<int64_t>(lines_seen);
+				last_line = line;
+				lines_seen++;
+			}, threads);
+			lines_ok = false;
+		}
+		catch (const JSONException &e)
+		{
+			lines_ok = lines_ok && e.what() == "Invalid JSON on line " + to_string(bad_line) && last_line == bad_line - 1 &&
+				lines_seen > 0;
+		}
+	}
+	print_test_result("Testing JSON::ParseLines()", lines_ok);
+
+	// Big enough to be split, with brackets, commas and quotes in the strings
+	string parallel_text = " [ ";
+	for (int i = 0; i < 5000; i++)
+		parallel_text += (i ? " , " : "") + string("{\"id\":") + to_string(i) + ",\"text\":\"a,]}\\\"[{\\\\\",\"list\":[" + to_string(i % 7) + ",{}]}";
+	parallel_text += " ] ";
+	string parallel_expected = JSON::Parse(parallel_text).Stringify();
+	bool parallel_ok = JSON::ParseParallel("[]").CountChildren() == 0 && JSON::ParseParallel(" {\"a\":[1,2]} ").Child("a").CountChildren() == 2 &&
+		JSON::ParseParallel("[1, \"x\", [2]]").Stringify() == "[1,\"x\",[2]]";
+	for (unsigned int threads = 1; threads <= 8; threads *= 2)
+		parallel_ok = parallel_ok && JSON::ParseParallel(parallel_text, threads).Stringify() == parallel_expected;
+	string parallel_invalid[] = { "", "[", "[1,]", "[,1]", "[1 2]", "[1]]", "[1] 2", "[\"a]", "[{]", "[1}", "[[1]",
+		parallel_text.substr(0, parallel_text.size() - 3), parallel_text + "1" };
+	for (size_t i = 0; i < sizeof(parallel_invalid) / sizeof(parallel_invalid[0]); i++)
+	{
+		try
+		{
+			JSON::ParseParallel(parallel_invalid[i], 4);
+			parallel_ok = false;
+		}
+		catch (const JSONException &e)
+		{
+		}
+	}
+
+	// Stray characters anywhere must be caught, or be in a string, as they are without threads
+	mt19937 parallel_random(5);
+	for (int i = 0; i < 24; i++)
+	{
+		string mutated = parallel_text;
+		mutated.insert(parallel_random() % mutated.size(), 1, ",]}[{\" \\"[i % 8]);
+		string serial, parallel;
+		try { serial = JSON::Parse(mutated).Stringify(); } catch (const JSONException &e) { serial = "invalid"; }
+		try { parallel = JSON::ParseParallel(mutated, 4).Stringify(); } catch (const JSONException &e) { parallel = "invalid"; }
+		parallel_ok = parallel_ok && serial == parallel;
+	}
+	print_test_result("Testing JSON::ParseParallel()", parallel_ok);
+
 	print_out(vert_sep.c_str());
 }